@@ -15,20 +15,62 @@ CONFIG += c++11
 # deprecated API in order to know how to port your code away from it.
 DEFINES += QT_DEPRECATED_WARNINGS
 
-HEADERS += constants.h \
+# benchmark mode counts heap allocations only in builds with CONFIG+=alloc_stats
+alloc_stats: DEFINES += DBLOGGER_COUNT_ALLOCATIONS
+
+win32: LIBS += -lpsapi
+
+# optional reader of fn_dblog using ODBC directly (CONFIG+=native_odbc, needs unixODBC on Linux)
+native_odbc {
+    DEFINES += DBLOGGER_NATIVE_ODBC
+    win32: LIBS += -lodbc32
+    else: LIBS += -lodbc
+}
+
+HEADERS += benchmark.h \
+           constants.h \
            database.h \
+           dbworker.h \
+           harvest.h \
+           headless.h \
+           logfilter.h \
+           logstore.h \
+           logtablemodel.h \
+           lsn.h \
            mainwindow.h \
+           objectnamecache.h \
+           odbcreader.h \
            query.h \
+           querystatistics.h \
+           rowmapping.h \
            session.h \
            shared.h \
+           spscqueue.h \
+           statementcache.h \
+           trackingstorage.h \
+           transactionassembler.h \
            ui/ui_buttons.h \
            ui/ui_mainwindow.h
 
-SOURCES += database.cpp \
+SOURCES += benchmark.cpp \
+           database.cpp \
+           dbworker.cpp \
+           harvest.cpp \
+           headless.cpp \
+           logfilter.cpp \
+           logstore.cpp \
+           logtablemodel.cpp \
+           lsn.cpp \
            main.cpp \
            mainwindow.cpp \
+           objectnamecache.cpp \
+           odbcreader.cpp \
            query.cpp \
-           session.cpp
+           querystatistics.cpp \
+           session.cpp \
+           statementcache.cpp \
+           trackingstorage.cpp \
+           transactionassembler.cpp
 
 RESOURCES += resource.qrc
 
@@ -0,0 +1,449 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include <cstring>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QRandomGenerator>
+#include <QStringList>
+#include <QTextStream>
+#include <QtGlobal>
+#include <QVector>
+#include "benchmark.h"
+#include "database.h"
+#include "query.h"
+#include "querystatistics.h"
+#include "statementcache.h"
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+// allocations are counted only in builds configured with CONFIG+=alloc_stats
+#ifdef DBLOGGER_COUNT_ALLOCATIONS
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<qint64> allocationCounter(0);
+
+void * operator new(std::size_t size) {
+
+    ++allocationCounter;
+    if (void * memory = std::malloc(size > 0 ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void * memory) noexcept { std::free(memory); }
+void operator delete(void * memory, std::size_t) noexcept { std::free(memory); }
+#endif
+
+LogBenchmark::LogBenchmark():
+    _logConnectionName(QStringLiteral("benchmarkLogConnection")),
+    _systemConnectionName(QStringLiteral("benchmarkSystemConnection")) {
+
+    _logConnection = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), this->_logConnectionName);
+    _logConnection.setDatabaseName(QStringLiteral(":memory:"));
+    _systemConnection = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), this->_systemConnectionName);
+    _systemConnection.setDatabaseName(QStringLiteral(":memory:"));
+}
+
+LogBenchmark::~LogBenchmark() {
+
+    StatementCache::invalidate(this->_logConnectionName);
+    StatementCache::invalidate(this->_systemConnectionName);
+    _logConnection.close();
+    _systemConnection.close();
+    _logConnection = QSqlDatabase();
+    _systemConnection = QSqlDatabase();
+    QSqlDatabase::removeDatabase(this->_logConnectionName);
+    QSqlDatabase::removeDatabase(this->_systemConnectionName);
+
+    if (!this->_logDatabaseFile.isEmpty())
+        QFile::remove(this->_logDatabaseFile);
+}
+
+bool LogBenchmark::isRequested(int argc, char * argv[]) {
+
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--benchmark") == 0)
+            return true;
+
+    return false;
+}
+
+bool LogBenchmark::parseArguments() {
+
+    QCommandLineParser parser;
+    const QCommandLineOption benchmarkOption(QStringLiteral("benchmark"),
+        QStringLiteral("Změřit propustnost načítání logu na syntetických datech."));
+    const QCommandLineOption rowsOption(QStringLiteral("rows"),
+        QStringLiteral("Počet záznamů logu."), QStringLiteral("N"));
+    const QCommandLineOption transactionSizeOption(QStringLiteral("transaction-size"),
+        QStringLiteral("Počet záznamů v jedné transakci."), QStringLiteral("N"));
+    const QCommandLineOption objectsOption(QStringLiteral("objects"),
+        QStringLiteral("Počet různých objektů (tabulek)."), QStringLiteral("N"));
+    const QCommandLineOption usersOption(QStringLiteral("users"),
+        QStringLiteral("Počet různých uživatelů."), QStringLiteral("N"));
+    const QCommandLineOption batchSizeOption(QStringLiteral("batch-size"),
+        QStringLiteral("Počet záznamů zapsaných v jedné transakci."), QStringLiteral("N"));
+    const QCommandLineOption nativeOdbcOption(QStringLiteral("native-odbc"),
+        QStringLiteral("Číst log přímo přes ODBC (ovladač SQLite ODBC)."));
+
+    parser.addOptions({ benchmarkOption, rowsOption, transactionSizeOption, objectsOption,
+                        usersOption, batchSizeOption, nativeOdbcOption });
+
+    if (!parser.parse(QCoreApplication::arguments()))
+        return false;
+
+    this->_settings._nativeOdbc = parser.isSet(nativeOdbcOption);
+
+    const QVector<QPair<QCommandLineOption, int *>> numericOptions {
+        qMakePair(rowsOption, &(this->_settings._rows)),
+        qMakePair(transactionSizeOption, &(this->_settings._transactionSize)),
+        qMakePair(objectsOption, &(this->_settings._objects)),
+        qMakePair(usersOption, &(this->_settings._users)),
+        qMakePair(batchSizeOption, &(this->_settings._batchSize)) };
+
+    for (auto it: numericOptions) {
+
+        if (parser.isSet(it.first)) {
+
+            bool valueOk = false;
+            *(it.second) = parser.value(it.first).toInt(&valueOk);
+            if (!valueOk || *(it.second) < 1)
+                return false;
+        }
+    }
+
+    // at least begin and commit
+    return (this->_settings._transactionSize >= 2);
+}
+
+// fn_dblog-shaped records: every transaction = LOP_BEGIN_XACT, data records, LOP_COMMIT_XACT
+bool LogBenchmark::generateWorkload() {
+
+    const int noOfColumns = 9;
+    const int rowsPerStatement = 100; // SQLite: max. 999 parameters per statement
+    const QString resourceForInsert = QStringLiteral(":/query/sql/benchmark/insert_fn_dblog.sql");
+
+    Query * const createTable = new Query(&(this->_logConnection));
+    bool workloadGenerated =
+        createTable->prepareQuery(QStringLiteral(":/query/sql/benchmark/create_fn_dblog.sql")) &&
+        createTable->processModifyQuery();
+    delete createTable;
+
+    // catalog stand-in: every object owns one allocation unit (names are resolved by harvester)
+    const qint64 firstAllocationUnitID = Q_INT64_C(72057594043236352);
+
+    Query * const createUnits = new Query(&(this->_logConnection));
+    workloadGenerated = workloadGenerated &&
+        createUnits->prepareQuery(QStringLiteral(":/query/sql/benchmark/create_allocation_units.sql")) &&
+        createUnits->processModifyQuery();
+    delete createUnits;
+
+    Query * const insertUnit = new Query(&(this->_logConnection));
+    workloadGenerated = workloadGenerated &&
+        insertUnit->prepareQuery(QStringLiteral(":/query/sql/benchmark/insert_allocation_unit.sql"));
+
+    for (int object = 0; object < this->_settings._objects && workloadGenerated; ++object) {
+
+        insertUnit->setBinding(0, QVariant(firstAllocationUnitID + object));
+        insertUnit->setBinding(1, QVariant(QStringLiteral("dbo.Table_%1").arg(object)));
+        workloadGenerated = insertUnit->processModifyQuery();
+    }
+    delete insertUnit;
+
+    if (!workloadGenerated)
+        return false;
+
+    static const QStringList dataOperations { QStringLiteral("LOP_INSERT_ROWS"),
+        QStringLiteral("LOP_MODIFY_ROW"), QStringLiteral("LOP_DELETE_ROWS") };
+    static const QStringList transactionNames { QStringLiteral("INSERT"),
+        QStringLiteral("UPDATE"), QStringLiteral("DELETE") };
+
+    QRandomGenerator generator(20200606); // same workload on every run
+    QDateTime currentTime = QDateTime::currentDateTime().addDays(-1);
+    quint32 vlfSequence = 0x2a, blockOffset = 0x10;
+    quint16 slot = 0;
+
+    Query * const fullStatement = new Query(&(this->_logConnection));
+    Query * partialStatement = nullptr;
+    workloadGenerated = fullStatement->prepareBatchQuery(resourceForInsert, rowsPerStatement);
+
+    QVector<QVariant> rowValues;
+    rowValues.reserve(rowsPerStatement * noOfColumns);
+
+    // buffered rows are written by full statement or (at the end) by statement of matching size
+    auto writeRows = [&]() -> bool {
+
+        const int noOfRows = rowValues.size() / noOfColumns;
+        Query * queryToExecute = fullStatement;
+
+        if (noOfRows != rowsPerStatement) {
+
+            partialStatement = new Query(&(this->_logConnection));
+            if (!partialStatement->prepareBatchQuery(resourceForInsert, noOfRows))
+                return false;
+            queryToExecute = partialStatement;
+        }
+
+        for (int i = 0; i < rowValues.size(); ++i)
+            queryToExecute->setBinding(i, rowValues.at(i));
+        rowValues.clear();
+
+        return queryToExecute->processModifyQuery();
+    };
+
+    this->_logConnection.transaction();
+
+    for (int row = 0, transactionNo = 0; row < this->_settings._rows && workloadGenerated;
+         ++transactionNo) {
+
+        const int transactionSize = qMin(this->_settings._transactionSize, this->_settings._rows - row);
+        const QString transactionID = QStringLiteral("0000:%1").arg(transactionNo, 8, 16, QChar('0'));
+        const QString userName =
+            QStringLiteral("user_%1").arg(generator.bounded(this->_settings._users));
+
+        // operation mix: insert / modify / delete
+        const int share = generator.bounded(100);
+        const int operation = (share < this->_settings._insertShare) ? 0
+            : (share < this->_settings._insertShare + this->_settings._modifyShare) ? 1 : 2;
+        const qint64 allocationUnitID =
+            firstAllocationUnitID + generator.bounded(this->_settings._objects);
+
+        for (int record = 0; record < transactionSize; ++record, ++row) {
+
+            // 20 records per log block, new VLF every 4096 blocks
+            if (++slot > 20) {
+
+                slot = 1;
+                if (++blockOffset > 0x1000) {
+
+                    blockOffset = 0x10;
+                    ++vlfSequence;
+                }
+            }
+            currentTime = currentTime.addMSecs(1);
+
+            const bool isBegin = (record == 0);
+            const bool isCommit = (record == transactionSize - 1 && transactionSize > 1);
+
+            rowValues << LSN(vlfSequence, blockOffset, slot).toString()
+                      << ((isBegin || isCommit) ? QVariant(Q_INT64_C(0)) : QVariant(allocationUnitID))
+                      << (isBegin ? QStringLiteral("LOP_BEGIN_XACT") : isCommit
+                                  ? QStringLiteral("LOP_COMMIT_XACT") : dataOperations.at(operation))
+                      << (isBegin ? QVariant(transactionNames.at(operation)) : QVariant(QVariant::String))
+                      << transactionID
+                      << (isBegin ? QVariant(currentTime.toString(Qt::ISODateWithMs))
+                                  : QVariant(QVariant::String))
+                      << (isCommit ? QVariant(currentTime.toString(Qt::ISODateWithMs))
+                                   : QVariant(QVariant::String))
+                      << QVariant(QVariant::String)
+                      << (isBegin ? QVariant(userName) : QVariant(QVariant::String));
+
+            if (rowValues.size() == rowsPerStatement * noOfColumns)
+                workloadGenerated = writeRows();
+        }
+    }
+
+    if (workloadGenerated && !rowValues.isEmpty())
+        workloadGenerated = writeRows();
+
+    if (workloadGenerated)
+        workloadGenerated = this->_logConnection.commit();
+    else
+        this->_logConnection.rollback();
+
+    delete fullStatement;
+    delete partialStatement;
+    return workloadGenerated;
+}
+
+bool LogBenchmark::createTrackingTable(const QString & tableName) {
+
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), tableName) };
+
+    Query * const queryToExecute = new Query(&(this->_systemConnection), customBindings);
+    bool tableCreated =
+        queryToExecute->prepareQuery(QStringLiteral(":/query/sql/benchmark/create_new_log_table.sql")) &&
+        queryToExecute->processModifyQuery();
+    delete queryToExecute;
+
+    // watermark is advanced with every persisted batch
+    Query * const watermarkQuery = new Query(&(this->_systemConnection));
+    tableCreated = tableCreated &&
+        watermarkQuery->prepareQuery(QStringLiteral(":/query/sql/benchmark/create_harvest_watermarks.sql")) &&
+        watermarkQuery->processModifyQuery();
+    delete watermarkQuery;
+
+    return tableCreated;
+}
+
+QJsonObject LogBenchmark::measurement(const QString & unit, const qint64 count,
+                                      const qint64 elapsed /* [ns] */) const {
+
+    QJsonObject result;
+    result.insert(unit, count);
+    result.insert(QStringLiteral("elapsedMs"), elapsed / 1000000);
+    result.insert(QStringLiteral("perSecond"), (elapsed > 0) ? (count * 1000000000.0 / elapsed) : 0.0);
+    return result;
+}
+
+int LogBenchmark::exec() {
+
+    if (!this->parseArguments()) {
+
+        QTextStream(stderr) << QStringLiteral("Neplatné parametry příkazové řádky.\n");
+        return 3;
+    }
+
+    // ODBC reader needs database which can be opened by other connection
+    if (this->_settings._nativeOdbc) {
+
+        if (!OdbcBulkReader::isAvailable()) {
+
+            QTextStream(stderr) << QStringLiteral("Přímé čtení přes ODBC není v této verzi k dispozici.\n");
+            return 3;
+        }
+
+        this->_logDatabaseFile = QDir::temp().filePath(QStringLiteral("dblogger_benchmark_%1.db")
+                                                       .arg(QCoreApplication::applicationPid()));
+        QFile::remove(this->_logDatabaseFile);
+        this->_logConnection.setDatabaseName(this->_logDatabaseFile);
+    }
+
+    if (!this->_logConnection.open() || !this->_systemConnection.open()) {
+
+        QTextStream(stderr) << QStringLiteral("Nepodařilo se otevřít databázi SQLite.\n");
+        return 2;
+    }
+
+    QJsonObject results;
+    QJsonObject workload;
+    workload.insert(QStringLiteral("rows"), this->_settings._rows);
+    workload.insert(QStringLiteral("transactionSize"), this->_settings._transactionSize);
+    workload.insert(QStringLiteral("objects"), this->_settings._objects);
+    workload.insert(QStringLiteral("users"), this->_settings._users);
+    workload.insert(QStringLiteral("batchSize"), this->_settings._batchSize);
+    workload.insert(QStringLiteral("reader"), this->_settings._nativeOdbc
+                    ? QStringLiteral("odbc") : QStringLiteral("qtsql"));
+    results.insert(QStringLiteral("workload"), workload);
+
+    QElapsedTimer timer;
+    qint64 allocations = noOfAllocations();
+
+    // generate fn_dblog stand-in
+    timer.start();
+    if (!this->generateWorkload())
+        return 1;
+    results.insert(QStringLiteral("generate"),
+                   this->measurement(QStringLiteral("rows"), this->_settings._rows, timer.nsecsElapsed()));
+
+    // raw scan through Query (streaming, nothing is kept)
+    const QString resourceForScan = QStringLiteral(":/query/sql/benchmark/retrieve_data_from_log.sql");
+    Query * const scanQuery = new Query(&(this->_logConnection));
+    scanQuery->setForwardOnly(true);
+    scanQuery->setClause(QStringLiteral(":logFilter"), CompiledLogFilter()._condition);
+    scanQuery->setClause(QStringLiteral(":imageColumns"), QString());
+    qint64 scannedRows = 0;
+    int noOfColumns = -1;
+
+    allocations = noOfAllocations();
+    timer.restart();
+    if (scanQuery->prepareQuery(resourceForScan)) {
+
+        scanQuery->setBinding(QStringLiteral(":fromLSN"), QString());
+        scanQuery->processSelectQuery([&scannedRows, &noOfColumns](const QueryRow & row) -> bool {
+
+            if (noOfColumns < 0)
+                noOfColumns = row.noOfColumns();
+            for (int column = 0; column < noOfColumns; ++column)
+                row.at(column);
+            ++scannedRows;
+            return true;
+        });
+    }
+    QJsonObject scan = this->measurement(QStringLiteral("rows"), scannedRows, timer.nsecsElapsed());
+    scan.insert(QStringLiteral("allocations"), noOfAllocations() - allocations);
+    results.insert(QStringLiteral("scan"), scan);
+    delete scanQuery;
+
+    // harvest path of Database
+    Database * const benchmarkDB = new Database(QUuid::createUuid(), 1, QStringLiteral("benchmarkUserConnection"),
+        DatabaseConnectionProps(QStringLiteral("."), sql::defaultPortNo, QStringLiteral("benchmark"), QString()));
+    benchmarkDB->setLogQueryResources(QStringLiteral(":/query/sql/benchmark/"));
+    benchmarkDB->setMaxParametersPerStatement(999);
+    benchmarkDB->setBatchSize(this->_settings._batchSize);
+    if (this->_settings._nativeOdbc)
+        benchmarkDB->setLogReader(Database::NATIVE_ODBC_READER);
+
+    allocations = noOfAllocations();
+    timer.restart();
+    const bool logLoaded = benchmarkDB->loadAllLogRecordsFromGivenLSN(&(this->_logConnection), LSN());
+    QJsonObject load = this->measurement(QStringLiteral("rows"), this->_settings._rows, timer.nsecsElapsed());
+    load.insert(QStringLiteral("transactions"), benchmarkDB->noOfLoadedTransactions());
+    load.insert(QStringLiteral("storeBytes"), benchmarkDB->loadedLogMemoryUsage());
+    load.insert(QStringLiteral("allocations"), noOfAllocations() - allocations);
+    results.insert(QStringLiteral("load"), load);
+
+    bool trackingTableUpdated = false;
+    if (logLoaded && this->createTrackingTable(benchmarkDB->logTableName())) {
+
+        allocations = noOfAllocations();
+        timer.restart();
+        trackingTableUpdated = benchmarkDB->updateTrackingTableWithLogData(&(this->_systemConnection));
+        QJsonObject persist = this->measurement(QStringLiteral("rows"),
+            benchmarkDB->ingestStatistics()._rows, timer.nsecsElapsed());
+        persist.insert(QStringLiteral("batches"), benchmarkDB->ingestStatistics()._batches);
+        persist.insert(QStringLiteral("statements"), benchmarkDB->ingestStatistics()._statements);
+        persist.insert(QStringLiteral("allocations"), noOfAllocations() - allocations);
+        results.insert(QStringLiteral("persist"), persist);
+    }
+    delete benchmarkDB;
+
+    results.insert(QStringLiteral("queries"), QueryStatistics::toJson());
+    results.insert(QStringLiteral("peakRssBytes"), peakResidentSetSize());
+    results.insert(QStringLiteral("success"), logLoaded && trackingTableUpdated);
+
+    QTextStream(stdout) << QJsonDocument(results).toJson(QJsonDocument::Indented);
+    return ((logLoaded && trackingTableUpdated) ? 0 : 1);
+}
+
+qint64 LogBenchmark::peakResidentSetSize() {
+
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return qint64(counters.PeakWorkingSetSize);
+#elif defined(Q_OS_LINUX)
+    QFile status(QStringLiteral("/proc/self/status"));
+    if (status.open(QIODevice::ReadOnly | QIODevice::Text)) {
+
+        const QStringList lines = QString(status.readAll()).split(QChar('\n'));
+        for (auto it: lines)
+            if (it.startsWith(QStringLiteral("VmHWM:")))
+                return it.mid(6).trimmed().split(QChar(' ')).first().toLongLong() * 1024;
+    }
+#endif
+    return -1;
+}
+
+qint64 LogBenchmark::noOfAllocations() {
+
+#ifdef DBLOGGER_COUNT_ALLOCATIONS
+    return allocationCounter.load();
+#else
+    return -1;
+#endif
+}
@@ -0,0 +1,55 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QJsonObject>
+#include <QSqlDatabase>
+#include <QString>
+
+// shape of synthetic fn_dblog workload
+struct WorkloadSettings {
+
+    int _rows = 1000000;
+    int _transactionSize = 10; // records per transaction (incl. begin/commit)
+    int _objects = 50;
+    int _users = 5;
+    int _insertShare = 50; // [%] of data records, rest is split between
+    int _modifyShare = 30; // modifications and deletions
+    int _batchSize = 5000;
+    bool _nativeOdbc = false; // log is read through ODBC (SQLite ODBC driver) from temporary file
+};
+
+// command-line mode: DBLogger --benchmark [--rows N] [--transaction-size N] [--objects N]
+// [--users N] [--batch-size N] [--native-odbc]; fn_dblog is served by in-memory SQLite database,
+// harvest path (Query, loadAllLogRecordsFromGivenLSN, updateTrackingTableWithLogData) runs unchanged
+class LogBenchmark {
+
+    public:
+        LogBenchmark();
+        ~LogBenchmark();
+
+        static bool isRequested(int, char * []);
+        int exec();
+
+    private:
+        bool parseArguments();
+        bool generateWorkload();
+        bool createTrackingTable(const QString &);
+        QJsonObject measurement(const QString &, const qint64, const qint64) const;
+
+        static qint64 peakResidentSetSize();
+        static qint64 noOfAllocations();
+
+        WorkloadSettings _settings;
+        const QString _logConnectionName;
+        const QString _systemConnectionName;
+        QString _logDatabaseFile;
+        QSqlDatabase _logConnection;
+        QSqlDatabase _systemConnection;
+};
+
+#endif // BENCHMARK_H
@@ -24,8 +24,50 @@ namespace sql {
     const static QString defaultSqlDriver = QStringLiteral("QODBC3");
     const static QString defaultPortNo = QStringLiteral("1433");
     const static QString systemConnection = QStringLiteral("systemConnection");
+    // connections of worker threads are clones named <connection><suffix><thread ID>
+    const static QString threadConnectionSuffix = QStringLiteral("_thread_");
 
     const static QString dbLog = QStringLiteral("fn_dblog");
+    const static QString logQueryResources = QStringLiteral(":/query/sql/master/");
+
+    // bulk insert into tracking tables (SQL Server limits: 1000 rows per VALUES clause,
+    // 2100 parameters per statement)
+    const static int defaultBatchSize = 5000;
+    const static int maxRowsPerInsert = 1000;
+    const static int maxParametersPerStatement = 2100;
+
+    // layout of tracking tables (1 = clustered by random GUID, 2 = clustered by commit LSN),
+    // older tables are migrated only on request (GUI asks before refresh, headless with --migrate)
+    const static int logTableLayout = 2;
+
+    // old rows of tracking tables are purged by batches of N rows (far below lock escalation),
+    // pause between batches leaves system database to harvest and UI [ms]; one run purges
+    // at most for given time (rest is purged after next harvest) [ms]
+    const static int retentionBatchSize = 1000;
+    const static int retentionBatchPause = 200;
+    const static int retentionRunDuration = 30000;
+
+    // idle prepared statements kept per connection (least recently used are dropped)
+    const static int statementCacheCapacity = 64;
+
+    // number of databases harvested at the same time (each worker has its own connections)
+    const static int defaultHarvestConcurrency = 4;
+
+    // connections reading one database's log at the same time (1 = single fn_dblog scan)
+    const static int defaultScanConcurrency = 1;
+
+    // capacity of queues between stages of pipelined harvest [records / transactions]
+    const static int pipelineQueueCapacity = 8192;
+
+    // progress of log reading is reported every N records
+    const static int progressInterval = 10000;
+
+    // rows per fetch of native ODBC reader (column-wise bound arrays)
+    const static int odbcRowArraySize = 5000;
+
+    // tracking table is shown page by page (keyset on EndLSN), only last used pages are kept
+    const static int logTablePageSize = 500;
+    const static int logTableCachedPages = 20;
 
 namespace map {
 
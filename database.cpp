@@ -3,11 +3,118 @@
  This program is distributed under the terms of the GNU General Public License.
 *******************************************************************************/
 
+#include <QElapsedTimer>
 #include <QFile>
+#include <QMutex>
 #include <QSqlQuery>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
 #include "database.h"
+#include "harvest.h"
 #include "query.h"
 #include "shared.h"
+#include "statementcache.h"
+#include "transactionassembler.h"
+
+// rows of queries (columns in order of select list)
+struct LastLSNRow {
+
+    LSN _lastLSN;
+};
+
+struct LogTableLayoutRow {
+
+    int _layout;
+};
+
+struct TableExistsRow {
+
+    int _exists;
+};
+
+struct RetentionCutoffRow {
+
+    QDateTime _cutoff;
+};
+
+static const auto logRecordMapping = mapColumns(&LogRecordRow::_allocationUnitID, &LogRecordRow::_operation,
+    &LogRecordRow::_transactionName, &LogRecordRow::_transactionID, &LogRecordRow::_beginTime,
+    &LogRecordRow::_endTime, &LogRecordRow::_userName, &LogRecordRow::_currentLSN);
+static const auto logRecordWithImagesMapping = mapColumns(&LogRecordRow::_allocationUnitID,
+    &LogRecordRow::_operation, &LogRecordRow::_transactionName, &LogRecordRow::_transactionID,
+    &LogRecordRow::_beginTime, &LogRecordRow::_endTime, &LogRecordRow::_userName, &LogRecordRow::_currentLSN,
+    &LogRecordRow::_rowLogContents0, &LogRecordRow::_rowLogContents1, &LogRecordRow::_logRecord);
+
+static const auto logRecordImageMapping = mapColumns(&LogRecordImage::_currentLSN,
+    &LogRecordImage::_transactionID, &LogRecordImage::_allocationUnitID, &LogRecordImage::_operation,
+    &LogRecordImage::_rowLogContents0, &LogRecordImage::_rowLogContents1, &LogRecordImage::_logRecord);
+
+// image columns appended to select list of log query; columns outside of profile are selected
+// as NULL, metadata profile selects none (rows are decoded by shorter mapping)
+static QString logImageColumns(const Database::logProjection projection) {
+
+    if (projection == Database::FULL_RECORD)
+        return QStringLiteral(", L.[RowLog Contents 0], L.[RowLog Contents 1], L.[Log Record]");
+    if (projection == Database::ROW_IMAGES)
+        return QStringLiteral(", L.[RowLog Contents 0], L.[RowLog Contents 1], NULL");
+
+    return QString();
+}
+
+static bool processLogRecords(Query * const queryToExecute, const Database::logProjection projection,
+                              const std::function<bool(const LogRecordRow &)> & recordHandler) {
+
+    return ((projection == Database::METADATA_ONLY)
+            ? queryToExecute->processSelectQuery(logRecordMapping, recordHandler)
+            : queryToExecute->processSelectQuery(logRecordWithImagesMapping, recordHandler));
+}
+
+// images of data records only; records read without images (log backups) are skipped
+static void captureImage(const LogRecordRow & record, QVector<LogRecordImage> & images) {
+
+    static const QStringList transactionControl { QStringLiteral("LOP_BEGIN_XACT"),
+        QStringLiteral("LOP_COMMIT_XACT"), QStringLiteral("LOP_ABORT_XACT") };
+
+    const bool noImages =
+        record._rowLogContents0.isNull() && record._rowLogContents1.isNull() && record._logRecord.isNull();
+    if (noImages || transactionControl.contains(record._operation))
+        return;
+
+    LogRecordImage image;
+    image._currentLSN = record._currentLSN;
+    image._transactionID = record._transactionID;
+    image._allocationUnitID = record._allocationUnitID;
+    image._operation = record._operation;
+    image._rowLogContents0 = record._rowLogContents0;
+    image._rowLogContents1 = record._rowLogContents1;
+    image._logRecord = record._logRecord;
+    images.push_back(image);
+    return;
+}
+
+// compiled filter replaces :logFilter placeholder (set before query is prepared), values are bound after
+static void bindLogFilter(Query * const queryToExecute, const CompiledLogFilter & logFilter) {
+
+    for (const auto & it : logFilter._parameters)
+        queryToExecute->setBinding(it.first, it.second);
+    return;
+}
+
+struct VirtualLogFileRow {
+
+    QString _firstLSN;
+    double _sizeMB;
+};
+
+struct DatabaseSettingsRow {
+
+    QString _lastFullBackup;
+    QString _lastDiffBackup;
+    QString _lastLogBackup;
+    QString _recoveryModel;
+    QString _state;
+};
 
 // system database connection settings
 DatabaseConnectionProps::DatabaseConnectionProps():
@@ -37,19 +144,15 @@ void DatabaseConnectionProps::setValueToVariable(const sql::map::variable variab
     return;
 }
 
-DatabaseLog::DatabaseLog(const QString & objectName, const QString & operation,
-    const QString & transactionName, const QString & transactionID, const QDateTime & beginTime,
-    const QDateTime & endTime, const QString & description, const QString & userName):
-    _objectName(objectName), _operation(operation), _transactionName(transactionName),
-    _transactionID(transactionID), _beginTime(beginTime), _endTime(endTime),
-    _description(description), _userName(userName) {}
-
 // system database
 Database::Database():
     _ID(QUuid::createUuid()), _databaseID(0), _connectionName(sql::systemConnection),
     _driverName(sql::defaultSqlDriver), _connectionEstablished(false), _connectionProperties(new
     DatabaseConnectionProps), _dbConnection(new QSqlDatabase), _logContents(nullptr),
-    _logTable(nullptr) {
+    _objectNames(nullptr), _batchSize(sql::defaultBatchSize), _logQueryResources(sql::logQueryResources),
+    _maxParametersPerStatement(sql::maxParametersPerStatement), _logReader(QT_SQL_READER),
+    _scanConcurrency(sql::defaultScanConcurrency), _pipelinedHarvest(false), _projection(METADATA_ONLY),
+    _trackingStorage(TrackingStorage::instance(TrackingStorage::TABLE_PER_DATABASE)) {
 
     *(_dbConnection) = QSqlDatabase::addDatabase(this->_driverName, this->_connectionName);
 }
@@ -59,35 +162,50 @@ Database::Database(const QUuid ID, const int dbID, const QString & connectionNam
                    const DatabaseConnectionProps & properties):
     _ID(ID), _databaseID(dbID), _connectionName(connectionName), _driverName(sql::defaultSqlDriver),
     _connectionEstablished(false), _connectionProperties(new DatabaseConnectionProps),
-     _dbConnection(new QSqlDatabase), _logContents(new QMap<QString, QVector<DatabaseLog>>) {
+     _dbConnection(new QSqlDatabase), _logContents(new LogStore),
+     _objectNames(new ObjectNameCache), _batchSize(sql::defaultBatchSize), _logQueryResources(sql::logQueryResources),
+     _maxParametersPerStatement(sql::maxParametersPerStatement), _logReader(QT_SQL_READER),
+     _scanConcurrency(sql::defaultScanConcurrency), _pipelinedHarvest(false), _projection(METADATA_ONLY),
+     _trackingStorage(TrackingStorage::instance(TrackingStorage::TABLE_PER_DATABASE)) {
 
     *(_connectionProperties) = properties;
     *(_dbConnection) = QSqlDatabase::addDatabase(this->_driverName, this->_connectionName);
-    _logTable = new QSqlTableModel(nullptr, QSqlDatabase::database(sql::systemConnection));
 }
 
 Database::Database(const Database & rhs):
     _ID(rhs._ID), _databaseID(rhs._databaseID), _connectionName(rhs._connectionName),
-    _driverName(rhs._driverName), _connectionEstablished(rhs._connectionEstablished) {
+    _driverName(rhs._driverName), _connectionEstablished(rhs._connectionEstablished),
+    _capturedImages(rhs._capturedImages), _batchSize(rhs._batchSize),
+    _ingestStatistics(rhs._ingestStatistics),
+    _logQueryResources(rhs._logQueryResources),
+    _maxParametersPerStatement(rhs._maxParametersPerStatement), _logReader(rhs._logReader),
+    _scanConcurrency(rhs._scanConcurrency), _pipelinedHarvest(rhs._pipelinedHarvest),
+    _projection(rhs._projection), _trackingStorage(rhs._trackingStorage) {
 
     _connectionProperties = new DatabaseConnectionProps;
     *(_connectionProperties) = *(rhs._connectionProperties);
-    _logContents = new QMap<QString, QVector<DatabaseLog>>;
+    _logContents = new LogStore;
     *(_logContents) = *(rhs._logContents);
+    _objectNames = new ObjectNameCache;
+    *(_objectNames) = *(rhs._objectNames);
+    _logFilter = rhs._logFilter;
+    _retentionPolicy = rhs._retentionPolicy;
     _dbConnection = new QSqlDatabase;
     *(_dbConnection) = *(rhs._dbConnection);
-    _logTable = new QSqlTableModel(nullptr, QSqlDatabase::database(sql::systemConnection));
 }
 
 Database::~Database() {
 
+    StatementCache::invalidate(this->_connectionName);
     delete _dbConnection;
     delete _connectionProperties;
+    delete _logContents;
+    delete _objectNames;
     QSqlDatabase::removeDatabase(this->_connectionName);
-    delete _logTable;
 }
 
-bool Database::connectToServer(const DatabaseConnectionProps * const props, QSqlError & error) const {
+// connection is only configured (not opened), it can be cloned for worker threads
+void Database::setConnectionString(const DatabaseConnectionProps * const props) const {
 
     const QString connectionDataSet =
         QStringLiteral("DRIVER={SQL Server};Server=") + props->serverName() +
@@ -95,10 +213,21 @@ bool Database::connectToServer(const DatabaseConnectionProps * const props, QSql
         props->userName() + QStringLiteral(";Port=") + props->portNo() + QStringLiteral(";Pwd=") +
         props->password() + QStringLiteral(";");
 
+    // statements prepared on previous connection are no longer valid (as well as object names)
+    StatementCache::invalidate(this->_connectionName);
+    if (this->_objectNames != nullptr)
+        this->_objectNames->clear();
+
     if (this->_dbConnection->isOpen())
         this->_dbConnection->close();
 
     _dbConnection->setDatabaseName(connectionDataSet);
+    return;
+}
+
+bool Database::connectToServer(const DatabaseConnectionProps * const props, QSqlError & error) const {
+
+    this->setConnectionString(props);
 
     const bool connectionEstablished = _dbConnection->open();
     if (!connectionEstablished)
@@ -107,6 +236,12 @@ bool Database::connectToServer(const DatabaseConnectionProps * const props, QSql
     return connectionEstablished;
 }
 
+// connection configured by setConnectionString (e.g. verified by a worker thread) is opened on demand
+bool Database::openConnection() const {
+
+    return (this->_dbConnection->isOpen() || this->_dbConnection->open());
+}
+
 bool Database::checkIfNameMatchesID() const {
 
     const QString resourceForQuery =
@@ -201,186 +336,1649 @@ bool Database::removeRecordFromTrackingTable(const QSqlDatabase * systemConnecti
     return dataModified;
 }
 
-const QString Database::retrieveLastLSNFromTrackingTable() const {
+bool Database::createWatermarkTable(const QSqlDatabase * systemConnection) {
 
-    QString lastLSN = QString();
+    const QString resourceForQuery = QStringLiteral(":/query/sql/create_harvest_watermarks.sql");
+    bool tableCreated = false;
 
-    const QString resourceForQuery =
-        QStringLiteral(":/query/sql/master/retrieve_last_lsn_from_log.sql");
+    Query * const queryToExecute = new Query(systemConnection);
+
+    if (queryToExecute->prepareQuery(resourceForQuery))
+        tableCreated = queryToExecute->processModifyQuery();
+
+    delete queryToExecute;
+    return tableCreated;
+}
+
+bool Database::createRetentionTables(const QSqlDatabase * systemConnection) {
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/create_retention_tables.sql");
+    bool tableCreated = false;
+
+    Query * const queryToExecute = new Query(systemConnection);
+
+    if (queryToExecute->prepareQuery(resourceForQuery))
+        tableCreated = queryToExecute->processModifyQuery();
+
+    delete queryToExecute;
+    return tableCreated;
+}
+
+bool Database::createLogFilterTable(const QSqlDatabase * systemConnection) {
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/create_log_filters.sql");
+    bool tableCreated = false;
+
+    Query * const queryToExecute = new Query(systemConnection);
+
+    if (queryToExecute->prepareQuery(resourceForQuery))
+        tableCreated = queryToExecute->processModifyQuery();
+
+    delete queryToExecute;
+    return tableCreated;
+}
+
+const LSN Database::retrieveLastLSNFromTrackingTable(const QSqlDatabase * systemConnection) const {
+
+    LSN lastLSN = LSN();
+
+    // watermark is preferred, tracking table itself serves as fallback for databases
+    // harvested before the watermark table existed
+    const QString resourceForQuery = QStringLiteral(":/query/sql/retrieve_harvest_watermark.sql");
 
     // set custom bindings
     const QVector<QPair<QString, QString>> customBindings
-      { qMakePair<QString, QString>(QStringLiteral(":dbName"), this->dbName()) };
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->logTableName()) };
 
-    Query * const queryToExecute = new Query(this->_dbConnection, customBindings);
+    Query * const queryToExecute = new Query(systemConnection, customBindings);
+    queryToExecute->setClause(QStringLiteral(":trackedRows"), this->trackedRows());
 
     if (queryToExecute->prepareQuery(resourceForQuery)) {
 
-        if (queryToExecute->processSelectQuery() && queryToExecute->noOfRowsInResults() != 0)
-            lastLSN = queryToExecute->rowFromResults(0).at(0).toString();
+        queryToExecute->setBinding(0, QVariant(this->ID().toString(QUuid::WithoutBraces)));
+
+        LastLSNRow lastLSNRow;
+        if (queryToExecute->selectFirstRow(mapColumns(&LastLSNRow::_lastLSN), lastLSNRow))
+            lastLSN = lastLSNRow._lastLSN;
     }
     delete queryToExecute;
     return lastLSN;
 }
 
-bool Database::loadAllLogRecordsFromGivenLSN(const QString & fromLSN) {
+// transactions committed up to this LSN are already stored (null = no harvest position yet)
+const LSN Database::retrieveScannedLSN(const QSqlDatabase * systemConnection) const {
 
-    const QString resourceForQuery =
-        QStringLiteral(":/query/sql/master/retrieve_data_from_log.sql");
-    bool dataAcquired = false;
+    LSN scannedLSN = LSN();
 
-    // set custom bindings
-    const QVector<QPair<QString, QString>> customBindings
-      { qMakePair<QString, QString>(QStringLiteral(":dbName"), this->dbName()) };
+    Query * const queryToExecute = new Query(systemConnection);
 
-    Query * const queryToExecute = new Query(this->_dbConnection, customBindings);
+    if (queryToExecute->prepareQuery(QStringLiteral(":/query/sql/retrieve_harvest_scanned_lsn.sql"))) {
 
-    if (queryToExecute->prepareQuery(resourceForQuery)) {
+        queryToExecute->setBinding(0, QVariant(this->ID().toString(QUuid::WithoutBraces)));
+
+        LastLSNRow scannedLSNRow;
+        if (queryToExecute->selectFirstRow(mapColumns(&LastLSNRow::_lastLSN), scannedLSNRow))
+            scannedLSN = scannedLSNRow._lastLSN;
+    }
+    delete queryToExecute;
+    return scannedLSN;
+}
+
+bool Database::advanceWatermark(const QSqlDatabase * systemConnection,
+                                const HarvestPosition & position) const {
 
-        queryToExecute->setBinding(QStringLiteral(":fromLSN"), fromLSN);
-        const bool queryProcessed = queryToExecute->processSelectQuery();
+    const QString databaseID = this->ID().toString(QUuid::WithoutBraces);
+    bool dataModified = false;
 
-        if (queryProcessed) {
+    Query * queryToExecute = new Query(systemConnection);
 
-            const int noOfRecords = queryToExecute->noOfRowsInResults();
-            if (noOfRecords < 1)
-                return false;
+    if (queryToExecute->prepareQuery(QStringLiteral(":/query/sql/update_harvest_watermark.sql"))) {
 
-            this->_logContents->clear();
+        queryToExecute->setBinding(0, QVariant(position._watermark.toBinary()));
+        queryToExecute->setBinding(1, QVariant(position._scannedLSN.toBinary()));
+        queryToExecute->setBinding(2, databaseID);
+        dataModified = queryToExecute->processModifyQuery();
 
-            for (int i = 0; i < noOfRecords; ++i) {
+        // first harvest of database - watermark does not exist yet
+        if (dataModified && queryToExecute->noOfRowsAffected() == 0) {
 
-                const QString transactionID = queryToExecute->rowFromResults(i).at(3).toString();
-                const DatabaseLog databaseLogRow(
-                    queryToExecute->rowFromResults(i).at(0).toString(),
-                    queryToExecute->rowFromResults(i).at(1).toString(),
-                    queryToExecute->rowFromResults(i).at(2).toString(), transactionID,
-                    queryToExecute->rowFromResults(i).at(4).toDateTime(),
-                    queryToExecute->rowFromResults(i).at(5).toDateTime(),
-                    queryToExecute->rowFromResults(i).at(6).toString(),
-                    queryToExecute->rowFromResults(i).at(7).toString());
+            delete queryToExecute;
+            queryToExecute = new Query(systemConnection);
 
-                // if map already contains key, add record to vector
-                if (this->_logContents->contains(transactionID)) {
+            dataModified =
+                queryToExecute->prepareQuery(QStringLiteral(":/query/sql/insert_harvest_watermark.sql"));
+            if (dataModified) {
 
-                    auto transactionRecord = this->_logContents->find(transactionID);
-                    transactionRecord.value().push_back(databaseLogRow);
-                }
-                else
-                    this->_logContents->insert(transactionID, QVector<DatabaseLog>{databaseLogRow});
+                queryToExecute->setBinding(0, QVariant(position._watermark.toBinary()));
+                queryToExecute->setBinding(1, QVariant(position._scannedLSN.toBinary()));
+                queryToExecute->setBinding(2, databaseID);
+                dataModified = queryToExecute->processModifyQuery();
             }
-            dataAcquired = true;
         }
     }
     delete queryToExecute;
-    return dataAcquired;
+    return dataModified;
 }
 
-bool Database::updateTrackingTableWithLogData(const QSqlDatabase * systemConnection) {
+// log backup as listed by msdb (LSNs are numeric there)
+struct CatalogedLogBackupRow {
 
-    const QString resourceForQuery = QString(":/query/sql/update_log_table_with_new_data.sql");
-    bool dataModified = false;
+    int _backupSetID = 0;
+    QString _firstLSN;
+    QString _lastLSN;
+    QDateTime _finished;
+    QString _fileName;
+};
 
-    for (auto it: *(this->_logContents)) {
+static const auto logBackupFileMapping = mapColumns(&LogBackupFile::_backupSetID, &LogBackupFile::_firstLSN,
+    &LogBackupFile::_lastLSN, &LogBackupFile::_finished, &LogBackupFile::_fileName);
 
-        Query * const queryToExecute = new Query(systemConnection);
+bool Database::createLogBackupTable(const QSqlDatabase * systemConnection) {
 
-        queryToExecute->setBinding(QStringLiteral(":tableName"), this->logTableName());
-        queryToExecute->setBinding(QStringLiteral(":databaseid"), QString::number(this->databaseID()));
-        queryToExecute->setBinding(QStringLiteral(":objectName"), "");
-        queryToExecute->setBinding(QStringLiteral(":operation"), "");
-        queryToExecute->setBinding(QStringLiteral(":transID"), it[0].transactionID());
-        queryToExecute->setBinding(QStringLiteral(":beginTime"), it[0].beginTime().toString(Qt::ISODate));
-        queryToExecute->setBinding(QStringLiteral(":endTime"), it[0].endTime().toString(Qt::ISODate));
-        queryToExecute->setBinding(QStringLiteral(":userName"), it[0].userName());
-        queryToExecute->setBinding(QStringLiteral(":beginLSN"), "");
-        queryToExecute->setBinding(QStringLiteral(":endLSN"), "");
+    const QString resourceForQuery = QStringLiteral(":/query/sql/create_log_backups.sql");
+    bool tableCreated = false;
 
-        if (queryToExecute->prepareQuery(resourceForQuery)) {
+    Query * const queryToExecute = new Query(systemConnection);
 
-            dataModified = queryToExecute->processModifyQuery();
-        }
+    if (queryToExecute->prepareQuery(resourceForQuery))
+        tableCreated = queryToExecute->processModifyQuery();
 
     delete queryToExecute;
-    return dataModified;
+    return tableCreated;
+}
+
+// minimal chain of log backups: ordered by first LSN, every file has to continue where previous one
+// ended and the last one reaches active log; files covering only tracked records are skipped
+bool Database::planLogBackups(const QSqlDatabase * userConnection, const QSqlDatabase * systemConnection,
+                              const LSN & fromLSN) {
+
+    this->_logBackupPlan = LogBackupPlan();
 
+    // first harvest reads active log only
+    if (fromLSN.isNull())
+        return true;
+
+    const LSN firstActiveLSN = this->retrieveFirstActiveLSN(userConnection);
+    if (firstActiveLSN.isNull())
+        return false;
+    if (fromLSN >= firstActiveLSN)
+        return true;
+
+    this->_logBackupPlan._activeLogTruncated = true;
+
+    // history in msdb can be purged => cached catalog is used if it cannot be refreshed
+    if (!this->refreshLogBackupCatalog(userConnection, systemConnection))
+        ErrorMessage::warning(QStringLiteral("Seznam záloh logu se nepodařilo aktualizovat."));
+
+    QVector<LogBackupFile> backups;
+    Query * const queryToExecute = new Query(systemConnection);
+    queryToExecute->setForwardOnly(true);
+
+    const bool catalogLoaded =
+        queryToExecute->prepareQuery(QStringLiteral(":/query/sql/retrieve_log_backup_chain.sql"));
+    if (catalogLoaded) {
+
+        queryToExecute->setBinding(0, QVariant(this->ID().toString(QUuid::WithoutBraces)));
+        queryToExecute->setBinding(1, QVariant(fromLSN.toBinary()));
+    }
+    const bool chainLoaded = catalogLoaded && queryToExecute->processSelectQuery(logBackupFileMapping,
+        [&backups](const LogBackupFile & backup) -> bool { backups.push_back(backup); return true; });
+    delete queryToExecute;
+
+    if (!chainLoaded)
+        return false;
+
+    LSN coveredLSN = fromLSN;
+    bool chainBroken = false;
+
+    for (const auto & it : backups) {
+
+        // copies of the same backup (or backups within already selected file)
+        if (it._lastLSN <= coveredLSN)
+            continue;
+
+        // records between coveredLSN and first LSN of file are not available any more
+        if (it._firstLSN > coveredLSN)
+            chainBroken = true;
+
+        this->_logBackupPlan._files.push_back(it);
+        coveredLSN = it._lastLSN;
+        if (coveredLSN >= firstActiveLSN)
+            break;
     }
+
+    if (chainBroken || coveredLSN < firstActiveLSN)
+        ErrorMessage::warning(QStringLiteral("Řetězec záloh logu databáze ") + this->dbName() +
+                              QStringLiteral(" je přerušen, chybějící záznamy nebudou sledovány."));
     return true;
 }
 
-bool Database::createLogTableForThisDB(const QSqlDatabase * systemConnection) {
+// backups made since last refresh are appended to catalog (one transaction)
+bool Database::refreshLogBackupCatalog(const QSqlDatabase * userConnection,
+                                       const QSqlDatabase * systemConnection) const {
 
-    const QString resourceForQuery = QString(":/query/sql/create_new_log_table.sql");
-    bool dataModified = false;
+    const QString databaseID = this->ID().toString(QUuid::WithoutBraces);
+    int lastBackupSetID = 0;
 
-    // set custom bindings
-    const QVector<QPair<QString, QString>> customBindings
-      { { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->logTableName()) },
-        { qMakePair<QString, QString>(QStringLiteral(":foreignKeyName"), this->logTableForeignKey()) } };
+    Query * queryToExecute = new Query(systemConnection);
+    bool catalogRefreshed =
+        queryToExecute->prepareQuery(QStringLiteral(":/query/sql/retrieve_last_cataloged_log_backup.sql"));
+    if (catalogRefreshed) {
 
-    Query * const queryToExecute = new Query(systemConnection, customBindings);
+        queryToExecute->setBinding(0, QVariant(databaseID));
+
+        CatalogedLogBackupRow lastBackup;
+        catalogRefreshed = queryToExecute->selectFirstRow(mapColumns(&CatalogedLogBackupRow::_backupSetID),
+                                                          lastBackup);
+        lastBackupSetID = lastBackup._backupSetID;
+    }
+    delete queryToExecute;
+
+    if (!catalogRefreshed)
+        return false;
+
+    QVector<LogBackupFile> newBackups;
+    queryToExecute = new Query(userConnection);
+    queryToExecute->setForwardOnly(true);
+
+    catalogRefreshed =
+        queryToExecute->prepareQuery(this->_logQueryResources + QStringLiteral("retrieve_log_backups.sql"));
+    if (catalogRefreshed) {
+
+        queryToExecute->setBinding(0, QVariant(lastBackupSetID));
+        catalogRefreshed = queryToExecute->processSelectQuery(
+            mapColumns(&CatalogedLogBackupRow::_backupSetID, &CatalogedLogBackupRow::_firstLSN,
+                       &CatalogedLogBackupRow::_lastLSN, &CatalogedLogBackupRow::_finished,
+                       &CatalogedLogBackupRow::_fileName),
+            [&newBackups](const CatalogedLogBackupRow & row) -> bool {
+
+                bool firstValid = false, lastValid = false;
+                const LogBackupFile backup { row._backupSetID, LSN::fromNumeric(row._firstLSN, &firstValid),
+                    LSN::fromNumeric(row._lastLSN, &lastValid), row._finished, row._fileName };
+
+                if (firstValid && lastValid)
+                    newBackups.push_back(backup);
+                return true;
+            });
+    }
+    delete queryToExecute;
+
+    if (!catalogRefreshed || newBackups.isEmpty())
+        return catalogRefreshed;
+
+    QSqlDatabase connection = QSqlDatabase::database(systemConnection->connectionName());
+    queryToExecute = new Query(systemConnection);
+    catalogRefreshed = connection.transaction() &&
+                       queryToExecute->prepareQuery(QStringLiteral(":/query/sql/insert_log_backup.sql"));
+
+    for (int backup = 0; backup < newBackups.size() && catalogRefreshed; ++backup) {
+
+        queryToExecute->setBinding(0, QVariant(databaseID));
+        queryToExecute->setBinding(1, QVariant(newBackups.at(backup)._backupSetID));
+        queryToExecute->setBinding(2, QVariant(newBackups.at(backup)._firstLSN.toBinary()));
+        queryToExecute->setBinding(3, QVariant(newBackups.at(backup)._lastLSN.toBinary()));
+        queryToExecute->setBinding(4, QVariant(newBackups.at(backup)._finished));
+        queryToExecute->setBinding(5, QVariant(newBackups.at(backup)._fileName));
+        catalogRefreshed = queryToExecute->processModifyQuery();
+    }
+    delete queryToExecute;
+
+    if (catalogRefreshed)
+        catalogRefreshed = connection.commit();
+    else
+        connection.rollback();
+
+    return catalogRefreshed;
+}
+
+// oldest record still available in active log (null if it cannot be read)
+const LSN Database::retrieveFirstActiveLSN(const QSqlDatabase * userConnection) const {
+
+    const QString resourceForQuery = this->_logQueryResources + QStringLiteral("retrieve_first_log_lsn.sql");
+    LSN firstLSN;
+
+    Query * const queryToExecute = new Query(userConnection);
+    queryToExecute->setForwardOnly(true);
 
     if (queryToExecute->prepareQuery(resourceForQuery)) {
 
-        dataModified = queryToExecute->processModifyQuery();
+        LastLSNRow firstLSNRow;
+        if (queryToExecute->selectFirstRow(mapColumns(&LastLSNRow::_lastLSN), firstLSNRow))
+            firstLSN = firstLSNRow._lastLSN;
     }
     delete queryToExecute;
-    return dataModified;
+    return firstLSN;
 }
 
-bool Database::dropLogTableOfThisDB(const QSqlDatabase * systemConnection) {
+// records of backup file in LSN order (same columns and filter as query of active log)
+bool Database::readLogBackup(const QSqlDatabase * userConnection, const LogBackupFile & backup,
+                             const CompiledLogFilter & logFilter,
+                             const std::function<bool(const LogRecordRow &)> & recordHandler) const {
 
-    const QString resourceForQuery = QString(":/query/sql/drop_log_table.sql");
-    bool dataModified = false;
+    const QString resourceForQuery =
+        this->_logQueryResources + QStringLiteral("retrieve_data_from_log_backup.sql");
+    bool backupRead = false;
+
+    Query * const queryToExecute = new Query(userConnection);
+    queryToExecute->setForwardOnly(true);
+    queryToExecute->setClause(QStringLiteral(":logFilter"), logFilter._condition);
+
+    if (queryToExecute->prepareQuery(resourceForQuery)) {
+
+        queryToExecute->setBinding(QStringLiteral(":fileName"), backup._fileName);
+        bindLogFilter(queryToExecute, logFilter);
+        backupRead = queryToExecute->processSelectQuery(logRecordMapping, recordHandler);
+    }
+    delete queryToExecute;
+    return backupRead;
+}
+
+bool Database::loadAllLogRecordsFromGivenLSN(const QSqlDatabase * userConnection,
+                                             const LSN & fromLSN) {
+
+    this->_loadedFromLSN = fromLSN;
+    this->_capturedImages = QVector<LogRecordImage>();
+
+    const QString resourceForQuery =
+        this->_logQueryResources + QStringLiteral("retrieve_data_from_log.sql");
+
+    // log backups are read by QtSql only (one file after another), so are images
+    const bool backupsPlanned = this->_logBackupPlan._activeLogTruncated;
+
+    if (!backupsPlanned && this->activeLogReader() == NATIVE_ODBC_READER &&
+        this->_projection == METADATA_ONLY)
+        return this->loadAllLogRecordsNatively(userConnection, resourceForQuery, fromLSN);
+
+    // range spanning several VLFs is read by more connections
+    if (!backupsPlanned && this->_scanConcurrency > 1) {
+
+        const QVector<LSN> chunkBoundaries = this->splitLogOnVlfBoundaries(userConnection, fromLSN);
+        if (chunkBoundaries.size() > 1)
+            return this->loadAllLogRecordsInParallel(userConnection, chunkBoundaries, fromLSN);
+    }
+
+    bool dataAcquired = false;
 
     // set custom bindings
     const QVector<QPair<QString, QString>> customBindings
-      { { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->logTableName()) } };
+      { qMakePair<QString, QString>(QStringLiteral(":dbName"), this->dbName()) };
 
-    Query * const queryToExecute = new Query(systemConnection, customBindings);
+    Query * const queryToExecute = new Query(userConnection, customBindings);
+    // cursor type is chosen when statement is prepared
+    queryToExecute->setForwardOnly(true);
+
+    // names of objects are resolved by cache (loaded before log is read)
+    if (!this->_objectNames->isLoaded() &&
+        !this->_objectNames->load(userConnection, this->_logQueryResources, this->dbName())) {
+
+        delete queryToExecute;
+        return false;
+    }
+    UnresolvedRecords unresolvedRecords;
+
+    const CompiledLogFilter logFilter = this->_logFilter.compile();
+    queryToExecute->setClause(QStringLiteral(":logFilter"), logFilter._condition);
+    queryToExecute->setClause(QStringLiteral(":imageColumns"), logImageColumns(this->_projection));
 
     if (queryToExecute->prepareQuery(resourceForQuery)) {
 
-        dataModified = queryToExecute->processModifyQuery();
+        // whole log is read if no LSN has been tracked yet (or if log was truncated after it)
+        queryToExecute->setBinding(QStringLiteral(":fromLSN"), (fromLSN.isNull() || backupsPlanned)
+            ? QString() : fromLSN.toFnDblogParameter());
+        bindLogFilter(queryToExecute, logFilter);
+
+        this->_logContents->clear();
+        LSN lastReadLSN = fromLSN;
+        int rowsProcessed = 0;
+
+        // records are grouped by transaction as they arrive
+        const std::function<bool(const LogRecordRow &)> appendRecord =
+            [this, &lastReadLSN, &rowsProcessed, &unresolvedRecords](const LogRecordRow & record) -> bool {
+
+                if (this->cancelRequested())
+                    return false;
+                if (++rowsProcessed % sql::progressInterval == 0)
+                    this->reportProgress(LOADING_LOG, rowsProcessed);
+
+                // starting LSN of fn_dblog is inclusive (record is already tracked),
+                // backups overlap with each other and with active log
+                if (!lastReadLSN.isNull() && record._currentLSN <= lastReadLSN)
+                    return true;
+                lastReadLSN = record._currentLSN;
+
+                this->_logContents->append(
+                    this->objectName(record._allocationUnitID, record._operation, record._transactionID,
+                                     unresolvedRecords), record._operation, record._transactionName,
+                    record._transactionID, record._beginTime, record._endTime, record._userName,
+                    record._currentLSN);
+                captureImage(record, this->_capturedImages);
+
+                return true;
+            };
+
+        bool backupsRead = true;
+        for (int backup = 0; backup < this->_logBackupPlan._files.size() && backupsRead; ++backup)
+            backupsRead = this->readLogBackup(userConnection, this->_logBackupPlan._files.at(backup),
+                                              logFilter, appendRecord);
+
+        const bool queryProcessed =
+            backupsRead && processLogRecords(queryToExecute, this->_projection, appendRecord);
+
+        // no new records is not an error
+        dataAcquired = queryProcessed && !this->cancelRequested() &&
+                       this->resolveObjectNames(userConnection, unresolvedRecords);
     }
     delete queryToExecute;
-    return dataModified;
+    return dataAcquired;
 }
 
-bool Database::saveConfiguration(const QSqlDatabase * systemConnection) {
+// starting LSNs of chunks of pending range: active VLFs (starting with the one containing fromLSN)
+// are split into at most _scanConcurrency runs of about the same size
+QVector<LSN> Database::splitLogOnVlfBoundaries(const QSqlDatabase * userConnection,
+                                               const LSN & fromLSN) const {
 
-    // check if database DB corresponds to its name
-    if (!this->checkIfNameMatchesID())
+    const QString resourceForQuery =
+        this->_logQueryResources + QStringLiteral("retrieve_virtual_log_files.sql");
+
+    Query * const queryToExecute = new Query(userConnection);
+    queryToExecute->setForwardOnly(true);
+
+    QVector<QPair<LSN, double>> vlfs;
+    const bool queryProcessed = queryToExecute->prepareQuery(resourceForQuery) &&
+        queryToExecute->processSelectQuery(
+            mapColumns(&VirtualLogFileRow::_firstLSN, &VirtualLogFileRow::_sizeMB),
+            [&vlfs, &fromLSN](const VirtualLogFileRow & row) -> bool {
+
+                bool lsnValid = false;
+                const LSN firstLSN = LSN::fromString(row._firstLSN, &lsnValid);
+                if (!lsnValid)
+                    return true;
+
+                // VLFs preceding the one containing fromLSN are already tracked
+                if (!fromLSN.isNull() && firstLSN <= fromLSN)
+                    vlfs.clear();
+                vlfs.push_back(qMakePair(firstLSN, row._sizeMB));
+                return true;
+            });
+    delete queryToExecute;
+
+    // single scan is used if log cannot be split
+    QVector<LSN> chunkBoundaries;
+    if (!queryProcessed || vlfs.size() < 2)
+        return chunkBoundaries;
+
+    double pendingSize = 0.0;
+    for (const auto & it : vlfs)
+        pendingSize += it.second;
+    const double chunkSize = pendingSize / this->_scanConcurrency;
+
+    // first chunk starts where sequential scan would start
+    chunkBoundaries.push_back(fromLSN);
+    double chunkFilled = 0.0;
+
+    for (int vlf = 0; vlf < vlfs.size(); ++vlf) {
+
+        if (vlf > 0 && chunkFilled >= chunkSize && chunkBoundaries.size() < this->_scanConcurrency) {
+
+            chunkBoundaries.push_back(vlfs.at(vlf).first);
+            chunkFilled = 0.0;
+        }
+        chunkFilled += vlfs.at(vlf).second;
+    }
+    return chunkBoundaries;
+}
+
+// chunks are read concurrently (each by its own connection) into compact buffers, every chunk
+// is merged into the store (in LSN order) as soon as it and all preceding chunks are finished
+bool Database::loadAllLogRecordsInParallel(const QSqlDatabase * userConnection,
+                                           const QVector<LSN> & chunkBoundaries, const LSN & fromLSN) {
+
+    if (!this->_objectNames->isLoaded() &&
+        !this->_objectNames->load(userConnection, this->_logQueryResources, this->dbName()))
         return false;
 
-    const QString resourceForQuery = QStringLiteral(":/query/sql/update_db_connection_settings.sql");
-    bool dataModified = false;
+    const CompiledLogFilter logFilter = this->_logFilter.compile();
+    QVector<LogChunk> chunks(chunkBoundaries.size());
+    for (int chunk = 0; chunk < chunks.size(); ++chunk) {
 
-    Query * const queryToExecute = new Query(systemConnection);
+        chunks[chunk]._filter = logFilter;
+        chunks[chunk]._from = chunkBoundaries.at(chunk);
+        if (chunk + 1 < chunks.size())
+            chunks[chunk]._to = chunkBoundaries.at(chunk + 1);
+    }
+
+    QMutex finishedMutex;
+    QWaitCondition chunkFinished;
+    QThreadPool scanPool;
+    scanPool.setMaxThreadCount(this->_scanConcurrency);
+    for (int chunk = 0; chunk < chunks.size(); ++chunk)
+        scanPool.start(new LogChunkTask(this, userConnection->connectionName(), &(chunks[chunk]),
+                                        &finishedMutex, &chunkFinished));
+
+    this->_logContents->clear();
+    UnresolvedRecords unresolvedRecords;
+    int rowsProcessed = 0;
+
+    // chunks are adjacent => concatenation is ordered by LSN
+    for (auto & chunk : chunks) {
+
+        finishedMutex.lock();
+        while (!chunk._finished)
+            chunkFinished.wait(&finishedMutex);
+        finishedMutex.unlock();
+
+        if (!chunk._success || this->cancelRequested()) {
+
+            // remaining chunks stop on their own if scan was cancelled
+            scanPool.waitForDone();
+            if (!chunk._error.isEmpty())
+                ErrorMessage::critical(chunk._error);
+            return false;
+        }
+
+        const LogRecordBuffer & records = chunk._records;
+        for (int record = 0; record < records.noOfRecords(); ++record) {
+
+            if (++rowsProcessed % sql::progressInterval == 0)
+                this->reportProgress(LOADING_LOG, rowsProcessed);
+
+            // starting LSN of fn_dblog is inclusive (record is already tracked)
+            if (!fromLSN.isNull() && records.currentLSN(record) <= fromLSN)
+                continue;
+
+            this->_logContents->append(
+                this->objectName(records.allocationUnitID(record), records.operation(record),
+                                 records.transactionID(record), unresolvedRecords),
+                records.operation(record), records.transactionName(record), records.transactionID(record),
+                records.beginTime(record), records.endTime(record), records.userName(record),
+                records.currentLSN(record));
+        }
+        for (const auto & it : chunk._images)
+            if (fromLSN.isNull() || it._currentLSN > fromLSN)
+                this->_capturedImages.push_back(it);
+
+        chunk._records.clear();
+        chunk._images = QVector<LogRecordImage>();
+        this->reportProgress(LOADING_LOG, rowsProcessed);
+    }
+    return this->resolveObjectNames(userConnection, unresolvedRecords);
+}
+
+// records of one chunk are only decoded (chunks are read by worker threads, grouping is done later)
+bool Database::loadLogChunk(const QSqlDatabase * userConnection, LogChunk & chunk) const {
+
+    const QString resourceForQuery =
+        this->_logQueryResources + QStringLiteral("retrieve_data_from_log_range.sql");
+
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":dbName"), this->dbName()) };
+
+    Query * const queryToExecute = new Query(userConnection, customBindings);
+    queryToExecute->setForwardOnly(true);
+    queryToExecute->setClause(QStringLiteral(":logFilter"), chunk._filter._condition);
+    queryToExecute->setClause(QStringLiteral(":imageColumns"), logImageColumns(this->_projection));
+
+    bool chunkLoaded = false;
     if (queryToExecute->prepareQuery(resourceForQuery)) {
 
-        queryToExecute->setAllBindingsForProps(this->connectionProperties());
-        queryToExecute->setBinding(QStringLiteral(":id"), this->ID().toString(QUuid::WithoutBraces));
-        dataModified = queryToExecute->processModifyQuery();
+        queryToExecute->setBinding(QStringLiteral(":fromLSN"), chunk._from.isNull()
+            ? QString() : chunk._from.toFnDblogParameter());
+        queryToExecute->setBinding(QStringLiteral(":toLSN"), chunk._to.isNull()
+            ? QString() : chunk._to.toFnDblogParameter());
+        bindLogFilter(queryToExecute, chunk._filter);
+
+        const bool queryProcessed = processLogRecords(queryToExecute, this->_projection,
+            [this, &chunk](const LogRecordRow & record) -> bool {
+
+                if (this->cancelRequested())
+                    return false;
+
+                // ending LSN of fn_dblog is inclusive (record belongs to next chunk)
+                if (!chunk._to.isNull() && record._currentLSN >= chunk._to)
+                    return true;
+
+                chunk._records.append(record._allocationUnitID, record._operation, record._transactionName,
+                                      record._transactionID, record._beginTime, record._endTime,
+                                      record._userName, record._currentLSN);
+                captureImage(record, chunk._images);
+                return true;
+            });
+
+        chunkLoaded = queryProcessed && !this->cancelRequested();
     }
     delete queryToExecute;
-    return dataModified;
+    return chunkLoaded;
 }
 
-bool Database::retrieveSettings(QMap<dbSettings, QString> & dbSettings) const {
+// same query and record handling as above, values are decoded from blocks of rows fetched by ODBC
+bool Database::loadAllLogRecordsNatively(const QSqlDatabase * userConnection,
+                                         const QString & resourceForQuery, const LSN & fromLSN) {
 
-    const QString resourceForQuery = QStringLiteral(":/query/sql/master/dbstatus.sql");
-    bool dataAcquired = false;
+    if (!this->_objectNames->isLoaded() &&
+        !this->_objectNames->load(userConnection, this->_logQueryResources, this->dbName()))
+        return false;
+    UnresolvedRecords unresolvedRecords;
 
-    Query * const queryToExecute = new Query(this->_dbConnection);
-    if (queryToExecute->prepareQuery(resourceForQuery)) {
+    // custom bindings are resolved by Query, statement itself is prepared by reader
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":dbName"), this->dbName()) };
 
-        queryToExecute->setBinding(QStringLiteral(":dbName"), this->dbName());
-        if (queryToExecute->processSelectQuery() && queryToExecute->noOfRowsInResults() != 0) {
+    const CompiledLogFilter logFilter = this->_logFilter.compile();
+    Query * const queryToResolve = new Query(userConnection, customBindings);
+    queryToResolve->setClause(QStringLiteral(":logFilter"), logFilter._condition);
+    queryToResolve->setClause(QStringLiteral(":imageColumns"), logImageColumns(METADATA_ONLY));
+    const bool queryResolved = queryToResolve->loadQueryString(resourceForQuery);
+    const QString queryString = queryToResolve->queryString();
+    delete queryToResolve;
 
-            for (int i = (int)LAST_FULL_BACKUP; i != int(END_OF_SETTINGS); ++i)
-                dbSettings.insert((Database::dbSettings)i, queryToExecute->rowFromResults(0).at(i).toString());
-            dataAcquired = true;
+    if (!queryResolved)
+        return false;
+
+    // buffer widths [characters] of select list
+    static const QVector<int> columnWidths { 20, 32, 33, 20, 24, 24, 128, 25 };
+
+    const QVector<QPair<QString, QString>> parameters =
+        QVector<QPair<QString, QString>> { qMakePair<QString, QString>(QStringLiteral(":fromLSN"),
+            fromLSN.isNull() ? QString() : fromLSN.toFnDblogParameter()) } + logFilter._parameters;
+
+    this->_logContents->clear();
+    int rowsProcessed = 0;
+    OdbcBulkReader reader;
+
+    const bool queryProcessed =
+        reader.connect(OdbcBulkReader::connectionString(*userConnection)) &&
+        reader.select(queryString, parameters, columnWidths,
+            [this, &fromLSN, &rowsProcessed, &unresolvedRecords](const OdbcRowSet & rows) -> bool {
+
+                if (this->cancelRequested())
+                    return false;
+
+                for (int row = 0; row < rows.size(); ++row) {
+
+                    if (!rows.isValid(row))
+                        continue;
+                    if (++rowsProcessed % sql::progressInterval == 0)
+                        this->reportProgress(LOADING_LOG, rowsProcessed);
+
+                    // starting LSN of fn_dblog is inclusive (record is already tracked)
+                    const LSN currentLSN = rows.lsn(7, row);
+                    if (!fromLSN.isNull() && currentLSN <= fromLSN)
+                        continue;
+
+                    const QString operation = rows.text(1, row);
+                    const QString transactionID = rows.text(3, row);
+                    this->_logContents->append(
+                        this->objectName(rows.text(0, row).toLongLong(), operation, transactionID,
+                                         unresolvedRecords), operation, rows.text(2, row), transactionID,
+                        rows.dateTime(4, row), rows.dateTime(5, row), rows.text(6, row), currentLSN);
+                }
+                return true;
+            });
+
+    if (!queryProcessed && !reader.lastError().isEmpty())
+        ErrorMessage::critical(reader.lastError());
+
+    // no new records is not an error
+    return (queryProcessed && !this->cancelRequested() &&
+            this->resolveObjectNames(userConnection, unresolvedRecords));
+}
+
+// name of object of appended record (records which could not be resolved yet are remembered)
+QString Database::objectName(const qint64 allocationUnitID, const QString & operation,
+                             const QString & transactionID, UnresolvedRecords & unresolvedRecords) {
+
+    this->_objectNames->noteOperation(operation, allocationUnitID);
+    const QString name = this->_objectNames->name(allocationUnitID);
+
+    if (name.isEmpty() && this->_objectNames->isPending(allocationUnitID))
+        unresolvedRecords.push_back(
+            UnresolvedRecord { this->_logContents->noOfRecords(), allocationUnitID, transactionID });
+
+    return name;
+}
+
+// units created or changed while log was written are looked up one by one
+bool Database::resolveObjectNames(const QSqlDatabase * userConnection,
+                                  const UnresolvedRecords & unresolvedRecords) {
+
+    if (unresolvedRecords.isEmpty())
+        return true;
+
+    if (!this->_objectNames->refresh(userConnection, this->_logQueryResources, this->dbName()))
+        return false;
+
+    for (const auto & it : unresolvedRecords)
+        this->_logContents->setObjectName(it._record, it._transactionID,
+                                          this->_objectNames->name(it._allocationUnitID));
+    return true;
+}
+
+static void bindTrackedTransaction(Query * const queryToExecute, const int position,
+                                   const QString & databaseID, const TrackedTransaction & row) {
+
+    queryToExecute->setBinding(position, databaseID);
+    queryToExecute->setBinding(position + 1, row._objectName);
+    queryToExecute->setBinding(position + 2, row._transactionName);
+    queryToExecute->setBinding(position + 3, row._transactionID);
+    queryToExecute->setBinding(position + 4, row._beginTime);
+    queryToExecute->setBinding(position + 5, row._endTime);
+    queryToExecute->setBinding(position + 6, row._userName);
+    queryToExecute->setBinding(position + 7, row._range.from().toBinary());
+    queryToExecute->setBinding(position + 8, row._range.to().toBinary());
+    return;
+}
+
+// statements are prepared once and reused (full-size one and the remainder of the last batch);
+// nullptr is returned if statement cannot be prepared
+static Query * insertStatement(const QString & resourceForQuery, const QSqlDatabase * systemConnection,
+                               const QVector<QPair<QString, QString>> & customBindings,
+                               const int noOfRows, const int rowsPerStatement, Query *& fullStatement,
+                               Query *& partialStatement, int & partialStatementRows) {
+
+    if (noOfRows == rowsPerStatement) {
+
+        if (fullStatement == nullptr) {
+
+            fullStatement = new Query(systemConnection, customBindings);
+            if (!fullStatement->prepareBatchQuery(resourceForQuery, noOfRows)) {
+
+                delete fullStatement;
+                fullStatement = nullptr;
+                return nullptr;
+            }
+        }
+        return fullStatement;
+    }
+
+    if (partialStatement == nullptr || partialStatementRows != noOfRows) {
+
+        delete partialStatement;
+        partialStatement = new Query(systemConnection, customBindings);
+        partialStatementRows = noOfRows;
+        // remainder of batch has arbitrary size - not worth caching
+        partialStatement->setCached(false);
+        if (!partialStatement->prepareBatchQuery(resourceForQuery, noOfRows)) {
+
+            delete partialStatement;
+            partialStatement = nullptr;
+            return nullptr;
+        }
+    }
+    return partialStatement;
+}
+
+bool Database::updateTrackingTableWithLogData(const QSqlDatabase * systemConnection) {
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/insert_log_records_batch.sql");
+    const int noOfColumns = logTableLabels._noOfInsertedColumns;
+    const int rowsPerStatement =
+        qMin(sql::maxRowsPerInsert, (this->_maxParametersPerStatement - 1) / noOfColumns);
+
+    this->_ingestStatistics = IngestStatistics();
+    QElapsedTimer timer;
+    timer.start();
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->logTableName()) };
+
+    // one row per committed transaction (in order of commits), open transactions are left
+    // for next harvest; assembler keeps aggregates only, but whole range is in loaded log already
+    const LogStore & store = *(this->_logContents);
+    TransactionAssembler assembler(
+        HarvestPosition { this->_loadedFromLSN, this->retrieveScannedLSN(systemConnection) });
+    QVector<TrackedTransaction> rows;
+    TrackedTransaction completedTransaction;
+
+    for (int record = 0; record < store.noOfRecords(); ++record) {
+
+        // records of units created after filter was compiled are filtered by name
+        if (!this->_logFilter.acceptsObject(store.objectName(record)))
+            continue;
+
+        const LogRecordRow logRecord { 0, store.operation(record), store.transactionName(record),
+            store.transactionID(record), store.beginTime(record), store.endTime(record),
+            store.userName(record), store.currentLSN(record) };
+
+        if (assembler.append(logRecord, store.objectName(record), completedTransaction) &&
+            this->_logFilter.accepts(completedTransaction._userName, completedTransaction._noOfDataRecords))
+            rows.push_back(completedTransaction);
+    }
+    const int noOfTransactions = rows.size();
+    this->_ingestStatistics._duplicates = assembler.noOfRepeatedCommits();
+
+    const QString databaseID = this->ID().toString(QUuid::WithoutBraces);
+    QSqlDatabase connection = QSqlDatabase::database(systemConnection->connectionName());
+
+    Query * fullStatement = nullptr;
+    Query * partialStatement = nullptr;
+    int partialStatementRows = 0;
+    bool dataModified = true;
+
+    for (int batchBegin = 0; batchBegin < noOfTransactions && dataModified &&
+         !this->cancelRequested(); batchBegin += this->_batchSize) {
+
+        // batch is not written in autocommit (watermark would not match stored rows)
+        const int batchEnd = qMin(batchBegin + this->_batchSize, noOfTransactions);
+        const bool batchOpened = connection.transaction();
+        dataModified = batchOpened;
+
+        for (int statementBegin = batchBegin; statementBegin < batchEnd && dataModified;
+             statementBegin += rowsPerStatement) {
+
+            const int noOfRows = qMin(rowsPerStatement, batchEnd - statementBegin);
+            Query * const queryToExecute = insertStatement(resourceForQuery, systemConnection, customBindings,
+                noOfRows, rowsPerStatement, fullStatement, partialStatement, partialStatementRows);
+
+            if (queryToExecute == nullptr) {
+                dataModified = false;
+                break;
+            }
+
+            for (int row = 0; row < noOfRows; ++row)
+                bindTrackedTransaction(queryToExecute, row * noOfColumns, databaseID,
+                                       rows.at(statementBegin + row));
+
+            dataModified = queryToExecute->processModifyQuery();
+            ++(this->_ingestStatistics._statements);
+        }
+
+        // watermark advances in the same transaction as the batch - it never points past
+        // stored data (position of last transaction of batch)
+        if (dataModified)
+            dataModified = this->advanceWatermark(systemConnection, rows.at(batchEnd - 1)._position);
+
+        if (dataModified) {
+
+            dataModified = connection.commit();
+            if (dataModified) {
+
+                this->_ingestStatistics._rows += (batchEnd - batchBegin);
+                ++(this->_ingestStatistics._batches);
+                this->reportProgress(UPDATING_TRACKING_TABLE, this->_ingestStatistics._rows);
+            }
+        }
+        else if (batchOpened)
+            connection.rollback();
+    }
+
+    delete fullStatement;
+    delete partialStatement;
+
+    // records read after last commit (or log without commits) move position as well
+    if (dataModified && !this->cancelRequested() && store.noOfRecords() > 0)
+        dataModified = this->advanceWatermark(systemConnection, assembler.position());
+
+    this->_ingestStatistics._elapsed = timer.nsecsElapsed();
+    return (dataModified && !this->cancelRequested());
+}
+
+// fetch stage runs in calling thread (connection belongs to it), grouping and persisting stages
+// run on their own threads with own connections; stages are connected by bounded queues,
+// i.e. slow writer stops reading of log (memory does not depend on size of log)
+bool Database::harvestLogPipelined(const QSqlDatabase * userConnection,
+                                   const QSqlDatabase * systemConnection, const LSN & fromLSN) {
+
+    this->_ingestStatistics = IngestStatistics();
+    QElapsedTimer timer;
+    timer.start();
+
+    // names of objects are resolved by cache (loaded before log is read)
+    if (!this->_objectNames->isLoaded() &&
+        !this->_objectNames->load(userConnection, this->_logQueryResources, this->dbName()))
+        return false;
+
+    SpscQueue<LogRecordRow> records(sql::pipelineQueueCapacity);
+    SpscQueue<TrackedTransaction> transactions(sql::pipelineQueueCapacity);
+    const QString userConnectionName = userConnection->connectionName();
+    const QString systemConnectionName = systemConnection->connectionName();
+    const HarvestPosition startPosition { fromLSN, this->retrieveScannedLSN(systemConnection) };
+    const CompiledLogFilter logFilter = this->_logFilter.compile();
+    HarvestPosition finalPosition;
+    bool recordsGrouped = false;
+    bool transactionsPersisted = false;
+
+    // images are stored by fetch stage as they are read
+    if (this->_projection != METADATA_ONLY && !this->prepareLogImageTable(systemConnection, fromLSN))
+        return false;
+
+    QThreadPool stagePool;
+    stagePool.setMaxThreadCount(2);
+    stagePool.start(new PipelineStageTask(
+        [this, &records, &transactions, &userConnectionName, &startPosition, &finalPosition,
+         &recordsGrouped]() -> void {
+            recordsGrouped = this->groupLogRecords(records, transactions, userConnectionName,
+                                                   startPosition, finalPosition); }));
+    stagePool.start(new PipelineStageTask(
+        [this, &transactions, &systemConnectionName, &finalPosition, &transactionsPersisted]() -> void {
+            transactionsPersisted = this->persistTrackedTransactions(transactions, systemConnectionName,
+                                                                     finalPosition); }));
+
+    const bool logFetched =
+        this->fetchLogRecords(userConnection, systemConnection, fromLSN, logFilter, records);
+    if (logFetched)
+        records.close();
+    else
+        records.abort();
+    stagePool.waitForDone();
+
+    // images of transactions which were not stored are read again by next harvest
+    const QString resourceForOrphans = QStringLiteral(":/query/sql/delete_orphaned_record_images.sql");
+    const bool logHarvested =
+        logFetched && recordsGrouped && transactionsPersisted && !this->cancelRequested() &&
+        (this->_projection == METADATA_ONLY ||
+         this->deleteRecordImages(systemConnection, resourceForOrphans, fromLSN));
+
+    this->_ingestStatistics._elapsed = timer.nsecsElapsed();
+    return logHarvested;
+}
+
+// fetch stage: rows are only decoded and handed over, images are written in batches
+bool Database::fetchLogRecords(const QSqlDatabase * userConnection, const QSqlDatabase * systemConnection,
+                               const LSN & fromLSN, const CompiledLogFilter & logFilter,
+                               SpscQueue<LogRecordRow> & records) {
+
+    const QString resourceForQuery =
+        this->_logQueryResources + QStringLiteral("retrieve_data_from_log.sql");
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":dbName"), this->dbName()) };
+
+    Query * const queryToExecute = new Query(userConnection, customBindings);
+    queryToExecute->setForwardOnly(true);
+    queryToExecute->setClause(QStringLiteral(":logFilter"), logFilter._condition);
+    queryToExecute->setClause(QStringLiteral(":imageColumns"), logImageColumns(this->_projection));
+
+    const bool backupsPlanned = this->_logBackupPlan._activeLogTruncated;
+    bool logFetched = false;
+    if (queryToExecute->prepareQuery(resourceForQuery)) {
+
+        // whole log is read if no LSN has been tracked yet (or if log was truncated after it)
+        queryToExecute->setBinding(QStringLiteral(":fromLSN"), (fromLSN.isNull() || backupsPlanned)
+            ? QString() : fromLSN.toFnDblogParameter());
+        bindLogFilter(queryToExecute, logFilter);
+
+        LSN lastReadLSN = fromLSN;
+        int rowsProcessed = 0;
+        QVector<LogRecordImage> images;
+
+        // log backups are streamed the same way before active log
+        const std::function<bool(const LogRecordRow &)> pushRecord =
+            [this, &lastReadLSN, &rowsProcessed, &records, &images, systemConnection]
+            (const LogRecordRow & record) -> bool {
+
+                if (this->cancelRequested())
+                    return false;
+                if (++rowsProcessed % sql::progressInterval == 0)
+                    this->reportProgress(LOADING_LOG, rowsProcessed);
+
+                // starting LSN of fn_dblog is inclusive (record is already tracked),
+                // backups overlap with each other and with active log
+                if (!lastReadLSN.isNull() && record._currentLSN <= lastReadLSN)
+                    return true;
+                lastReadLSN = record._currentLSN;
+
+                captureImage(record, images);
+                if (images.size() >= this->_batchSize) {
+
+                    if (!this->storeRecordImages(systemConnection, images))
+                        return false;
+                    images.clear();
+                }
+
+                // false = later stage failed
+                return records.push(record);
+            };
+
+        bool backupsRead = true;
+        for (int backup = 0; backup < this->_logBackupPlan._files.size() && backupsRead; ++backup)
+            backupsRead = this->readLogBackup(userConnection, this->_logBackupPlan._files.at(backup),
+                                              logFilter, pushRecord);
+
+        const bool queryProcessed =
+            backupsRead && processLogRecords(queryToExecute, this->_projection, pushRecord);
+
+        logFetched = queryProcessed && !records.isAborted() && !this->cancelRequested() &&
+                     this->storeRecordImages(systemConnection, images);
+    }
+    delete queryToExecute;
+    return logFetched;
+}
+
+// grouping stage: transactions are handed over as they commit (see TransactionAssembler)
+bool Database::groupLogRecords(SpscQueue<LogRecordRow> & records,
+                               SpscQueue<TrackedTransaction> & transactions,
+                               const QString & userConnectionName, const HarvestPosition & startPosition,
+                               HarvestPosition & finalPosition) {
+
+    TransactionAssembler assembler(startPosition);
+    TrackedTransaction completedTransaction;
+
+    // names of units created while log was read are looked up immediately (by own connection)
+    ThreadConnection * nameConnection = nullptr;
+    bool recordsGrouped = true;
+    LogRecordRow record;
+
+    while (recordsGrouped && records.pop(record)) {
+
+        this->_objectNames->noteOperation(record._operation, record._allocationUnitID);
+        QString objectName = this->_objectNames->name(record._allocationUnitID);
+
+        if (objectName.isEmpty() && this->_objectNames->isPending(record._allocationUnitID)) {
+
+            if (nameConnection == nullptr)
+                nameConnection = new ThreadConnection(userConnectionName);
+            recordsGrouped = nameConnection->isOpen() &&
+                this->_objectNames->refresh(nameConnection->connection(), this->_logQueryResources,
+                                            this->dbName());
+            objectName = this->_objectNames->name(record._allocationUnitID);
+        }
+
+        // records of units created after filter was compiled are filtered by name
+        if (!this->_logFilter.acceptsObject(objectName))
+            continue;
+
+        if (assembler.append(record, objectName, completedTransaction) &&
+            this->_logFilter.accepts(completedTransaction._userName, completedTransaction._noOfDataRecords))
+            recordsGrouped = recordsGrouped && transactions.push(completedTransaction);
+    }
+    delete nameConnection;
+    this->_ingestStatistics._duplicates = assembler.noOfRepeatedCommits();
+
+    // records stop arriving because fetch stage failed (or was cancelled)
+    recordsGrouped = recordsGrouped && !records.isAborted() && !this->cancelRequested();
+
+    if (recordsGrouped) {
+
+        // written before queue is closed (closing publishes it to persisting stage)
+        finalPosition = assembler.position();
+        transactions.close();
+    }
+    else {
+
+        records.abort();
+        transactions.abort();
+    }
+    return recordsGrouped;
+}
+
+// persisting stage: batch = one transaction of system database, position of its last row is stored
+// with it; final position (valid once queue is closed) is stored after the last batch
+bool Database::persistTrackedTransactions(SpscQueue<TrackedTransaction> & transactions,
+                                          const QString & systemConnectionName,
+                                          const HarvestPosition & finalPosition) {
+
+    const ThreadConnection systemConnection(systemConnectionName);
+    if (!systemConnection.isOpen()) {
+
+        ErrorMessage::critical(systemConnection.lastError());
+        transactions.abort();
+        return false;
+    }
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/insert_log_records_batch.sql");
+    const int noOfColumns = logTableLabels._noOfInsertedColumns;
+    const int rowsPerStatement =
+        qMin(sql::maxRowsPerInsert, (this->_maxParametersPerStatement - 1) / noOfColumns);
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->logTableName()) };
+
+    const QString databaseID = this->ID().toString(QUuid::WithoutBraces);
+    QSqlDatabase connection = QSqlDatabase::database(systemConnection.connection()->connectionName());
+
+    Query * fullStatement = nullptr;
+    Query * partialStatement = nullptr;
+    int partialStatementRows = 0;
+    bool dataModified = true;
+    bool streamEnded = false;
+
+    QVector<TrackedTransaction> statementRows;
+    statementRows.reserve(rowsPerStatement);
+
+    while (dataModified && !streamEnded) {
+
+        int batchRows = 0;
+        bool batchOpened = false;
+        HarvestPosition batchPosition;
+
+        while (dataModified && !streamEnded && batchRows < this->_batchSize) {
+
+            // rows of one statement are collected before database transaction is (re)used
+            statementRows.clear();
+            const int statementCapacity = qMin(rowsPerStatement, this->_batchSize - batchRows);
+            TrackedTransaction row;
+
+            while (statementRows.size() < statementCapacity) {
+
+                if (!transactions.pop(row)) {
+                    streamEnded = true;
+                    break;
+                }
+                statementRows.push_back(row);
+            }
+            if (statementRows.isEmpty() || transactions.isAborted())
+                break;
+
+            if (!batchOpened)
+                batchOpened = connection.transaction();
+
+            Query * const queryToExecute = insertStatement(resourceForQuery, systemConnection.connection(),
+                customBindings, statementRows.size(), rowsPerStatement, fullStatement, partialStatement,
+                partialStatementRows);
+
+            if (!batchOpened || queryToExecute == nullptr) {
+                dataModified = false;
+                break;
+            }
+
+            for (int row = 0; row < statementRows.size(); ++row)
+                bindTrackedTransaction(queryToExecute, row * noOfColumns, databaseID, statementRows.at(row));
+
+            dataModified = queryToExecute->processModifyQuery();
+            ++(this->_ingestStatistics._statements);
+            batchRows += statementRows.size();
+            batchPosition = statementRows.last()._position;
+        }
+
+        if (!batchOpened)
+            break;
+
+        // batch of aborted harvest is not stored
+        dataModified = dataModified && !transactions.isAborted();
+
+        if (dataModified)
+            dataModified = this->advanceWatermark(systemConnection.connection(), batchPosition);
+
+        if (dataModified) {
+
+            dataModified = connection.commit();
+            if (dataModified) {
+
+                this->_ingestStatistics._rows += batchRows;
+                ++(this->_ingestStatistics._batches);
+            }
+        }
+        else
+            connection.rollback();
+    }
+
+    delete fullStatement;
+    delete partialStatement;
+
+    // records read after last commit move position as well
+    if (dataModified && !transactions.isAborted())
+        dataModified = this->advanceWatermark(systemConnection.connection(), finalPosition);
+
+    if (!dataModified)
+        transactions.abort();
+    return (dataModified && !transactions.isAborted());
+}
+
+// images after given LSN could have been stored by interrupted harvest
+bool Database::prepareLogImageTable(const QSqlDatabase * systemConnection, const LSN & fromLSN) const {
+
+    const QString resourceForDeletion = QStringLiteral(":/query/sql/delete_record_images_from_lsn.sql");
+    return (this->createLogImageTable(systemConnection) &&
+            this->deleteRecordImages(systemConnection, resourceForDeletion, fromLSN));
+}
+
+// images are captured by the same scan as metadata (see loadAllLogRecordsFromGivenLSN) and written
+// after tracking table was updated; images of transactions which were not stored (still open,
+// aborted, filtered out) are removed afterwards and captured again by next harvest
+bool Database::storeCapturedImages(const QSqlDatabase * systemConnection, const LSN & fromLSN) {
+
+    if (this->_projection == METADATA_ONLY)
+        return true;
+
+    bool imagesStored = this->prepareLogImageTable(systemConnection, fromLSN);
+    for (int batchBegin = 0; batchBegin < this->_capturedImages.size() && imagesStored &&
+         !this->cancelRequested(); batchBegin += this->_batchSize)
+        imagesStored = this->storeRecordImages(systemConnection,
+                                               this->_capturedImages.mid(batchBegin, this->_batchSize));
+    this->_capturedImages = QVector<LogRecordImage>();
+
+    const QString resourceForOrphans = QStringLiteral(":/query/sql/delete_orphaned_record_images.sql");
+    return (imagesStored && !this->cancelRequested() &&
+            this->deleteRecordImages(systemConnection, resourceForOrphans, fromLSN));
+}
+
+// images kept in image table are used if transaction was harvested with them (by any profile, profile
+// of this process does not matter), otherwise they are read from log (i.e. only while log still
+// contains the transaction)
+bool Database::loadTransactionImages(const QSqlDatabase * userConnection,
+                                     const QSqlDatabase * systemConnection, const QString & transactionID,
+                                     const LSNRange & range, QVector<LogRecordImage> & images) const {
+
+    images.clear();
+    const auto appendImage = [&images](const LogRecordImage & image) -> bool
+        { images.push_back(image); return true; };
+
+    // table does not exist if database has not been harvested with images yet
+    const QVector<QPair<QString, QString>> tableBindings
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->logImageTableName()) };
+
+    Query * const tableQuery = new Query(systemConnection, tableBindings);
+    TableExistsRow tableExistsRow { 0 };
+    if (tableQuery->prepareQuery(QStringLiteral(":/query/sql/retrieve_table_exists.sql")))
+        tableQuery->selectFirstRow(mapColumns(&TableExistsRow::_exists), tableExistsRow);
+    delete tableQuery;
+
+    if (tableExistsRow._exists != 0) {
+
+        // set custom bindings
+        const QVector<QPair<QString, QString>> customBindings
+          { qMakePair<QString, QString>(QStringLiteral(":imageTableName"), this->logImageTableName()) };
+
+        Query * const queryToExecute = new Query(systemConnection, customBindings);
+        queryToExecute->setForwardOnly(true);
+
+        if (queryToExecute->prepareQuery(QStringLiteral(":/query/sql/retrieve_stored_record_images.sql"))) {
+
+            queryToExecute->setBinding(0, QVariant(range.from().toBinary()));
+            queryToExecute->setBinding(1, QVariant(range.to().toBinary()));
+            queryToExecute->setBinding(2, transactionID);
+            if (!queryToExecute->processSelectQuery(logRecordImageMapping, appendImage))
+                images.clear();
+        }
+        delete queryToExecute;
+
+        if (!images.isEmpty())
+            return true;
+    }
+
+    const QString resourceForQuery = this->_logQueryResources + QStringLiteral("retrieve_transaction_images.sql");
+    bool imagesLoaded = false;
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":dbName"), this->dbName()) };
+
+    Query * const queryToExecute = new Query(userConnection, customBindings);
+    queryToExecute->setForwardOnly(true);
+
+    if (queryToExecute->prepareQuery(resourceForQuery)) {
+
+        queryToExecute->setBinding(QStringLiteral(":fromLSN"), range.from().toFnDblogParameter());
+        queryToExecute->setBinding(QStringLiteral(":toLSN"), range.to().toFnDblogParameter());
+        queryToExecute->setBinding(QStringLiteral(":transactionID"), transactionID);
+        imagesLoaded = queryToExecute->processSelectQuery(logRecordImageMapping, appendImage);
+    }
+    delete queryToExecute;
+    return imagesLoaded;
+}
+
+// image table exists only for profiles with images, column of whole record is always present
+// (it stays NULL for row images) => stored images are read the same way whatever the profile was
+bool Database::createLogImageTable(const QSqlDatabase * systemConnection) const {
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/create_log_image_table.sql");
+    bool tableCreated = false;
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":imageTableName"), this->logImageTableName()) };
+
+    Query * const queryToExecute = new Query(systemConnection, customBindings);
+
+    if (queryToExecute->prepareQuery(resourceForQuery))
+        tableCreated = queryToExecute->processModifyQuery();
+
+    delete queryToExecute;
+    return tableCreated;
+}
+
+// one transaction of system database per call
+bool Database::storeRecordImages(const QSqlDatabase * systemConnection,
+                                 const QVector<LogRecordImage> & images) const {
+
+    if (images.isEmpty())
+        return true;
+
+    const bool fullRecord = (this->_projection == FULL_RECORD);
+    const QString resourceForQuery = fullRecord
+        ? QStringLiteral(":/query/sql/insert_full_record_images_batch.sql")
+        : QStringLiteral(":/query/sql/insert_record_images_batch.sql");
+    const int noOfColumns = fullRecord ? 7 : 6;
+    const int rowsPerStatement =
+        qMin(sql::maxRowsPerInsert, (this->_maxParametersPerStatement - 1) / noOfColumns);
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":imageTableName"), this->logImageTableName()) };
+
+    QSqlDatabase connection = QSqlDatabase::database(systemConnection->connectionName());
+    Query * fullStatement = nullptr;
+    Query * partialStatement = nullptr;
+    int partialStatementRows = 0;
+    bool dataModified = connection.transaction();
+
+    for (int statementBegin = 0; statementBegin < images.size() && dataModified;
+         statementBegin += rowsPerStatement) {
+
+        const int noOfRows = qMin(rowsPerStatement, images.size() - statementBegin);
+        Query * const queryToExecute = insertStatement(resourceForQuery, systemConnection, customBindings,
+            noOfRows, rowsPerStatement, fullStatement, partialStatement, partialStatementRows);
+
+        if (queryToExecute == nullptr) {
+            dataModified = false;
+            break;
+        }
+
+        for (int row = 0; row < noOfRows; ++row) {
+
+            const LogRecordImage & image = images.at(statementBegin + row);
+            const int position = row * noOfColumns;
+            queryToExecute->setBinding(position, QVariant(image._currentLSN.toBinary()));
+            queryToExecute->setBinding(position + 1, image._transactionID);
+            queryToExecute->setBinding(position + 2, QVariant(image._allocationUnitID));
+            queryToExecute->setBinding(position + 3, image._operation);
+            queryToExecute->setBinding(position + 4, QVariant(image._rowLogContents0));
+            queryToExecute->setBinding(position + 5, QVariant(image._rowLogContents1));
+            if (fullRecord)
+                queryToExecute->setBinding(position + 6, QVariant(image._logRecord));
+        }
+        dataModified = queryToExecute->processModifyQuery();
+    }
+
+    delete fullStatement;
+    delete partialStatement;
+
+    if (dataModified)
+        dataModified = connection.commit();
+    else
+        connection.rollback();
+
+    return dataModified;
+}
+
+// images of records after given LSN (all images for null LSN)
+bool Database::deleteRecordImages(const QSqlDatabase * systemConnection, const QString & resourceForQuery,
+                                  const LSN & fromLSN) const {
+
+    bool dataModified = false;
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":imageTableName"), this->logImageTableName()),
+        qMakePair<QString, QString>(QStringLiteral(":tableName"), this->logTableName()) };
+
+    Query * const queryToExecute = new Query(systemConnection, customBindings);
+    queryToExecute->setClause(QStringLiteral(":trackedRows"), this->trackedRows());
+
+    if (queryToExecute->prepareQuery(resourceForQuery)) {
+
+        queryToExecute->setBinding(0, QVariant(fromLSN.toBinary()));
+        dataModified = queryToExecute->processModifyQuery();
+    }
+    delete queryToExecute;
+    return dataModified;
+}
+
+// own table is created (shared table exists already - nothing to do)
+bool Database::createLogTableForThisDB(const QSqlDatabase * systemConnection) {
+
+    return this->_trackingStorage->create(systemConnection, this->ID());
+}
+
+// layout of table is found from type of its ID column (only catalog is read, table is not touched)
+bool Database::logTableNeedsMigration(const QSqlDatabase * systemConnection, bool & needsMigration) const {
+
+    needsMigration = false;
+
+    // shared table is created with current layout
+    if (this->_trackingStorage->mode() == TrackingStorage::SHARED_TABLE)
+        return true;
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->logTableName()) };
+
+    Query * const queryToExecute = new Query(systemConnection, customBindings);
+
+    // table which does not exist is not migrated
+    LogTableLayoutRow layoutRow { sql::logTableLayout };
+    const bool layoutLoaded =
+        queryToExecute->prepareQuery(QStringLiteral(":/query/sql/retrieve_log_table_layout.sql")) &&
+        queryToExecute->processSelectQuery(mapColumns(&LogTableLayoutRow::_layout),
+            [&layoutRow](const LogTableLayoutRow & row) -> bool { layoutRow = row; return false; });
+    delete queryToExecute;
+
+    needsMigration = layoutLoaded && layoutRow._layout < sql::logTableLayout;
+    return layoutLoaded;
+}
+
+// migration rebuilds clustered index (in one transaction of system database), it may take long
+// for big tables => it is started only on request (never when session starts)
+bool Database::migrateLogTableOfThisDB(const QSqlDatabase * systemConnection) {
+
+    bool needsMigration = false;
+    if (!this->logTableNeedsMigration(systemConnection, needsMigration))
+        return false;
+    if (!needsMigration)
+        return true;
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->logTableName()) };
+
+    QSqlDatabase connection = QSqlDatabase::database(systemConnection->connectionName());
+    bool dataModified = connection.transaction();
+
+    Query * const queryToExecute = new Query(systemConnection, customBindings);
+    dataModified = dataModified &&
+        queryToExecute->prepareQuery(QStringLiteral(":/query/sql/migrate_log_table.sql")) &&
+        queryToExecute->processModifyQuery();
+    delete queryToExecute;
+
+    if (dataModified)
+        dataModified = connection.commit();
+    else
+        connection.rollback();
+    return dataModified;
+}
+
+// rows in shared table are removed with record of database (cascade)
+bool Database::dropLogTableOfThisDB(const QSqlDatabase * systemConnection) {
+
+    bool dataModified = this->_trackingStorage->drop(systemConnection, this->ID());
+
+    // images are kept only if database was harvested with them
+    if (dataModified) {
+
+        const QVector<QPair<QString, QString>> imageBindings
+          { qMakePair<QString, QString>(QStringLiteral(":imageTableName"), this->logImageTableName()) };
+
+        Query * const dropImages = new Query(systemConnection, imageBindings);
+        dataModified = dropImages->prepareQuery(QStringLiteral(":/query/sql/drop_log_image_table.sql")) &&
+                       dropImages->processModifyQuery();
+        delete dropImages;
+    }
+    return dataModified;
+}
+
+// rows older than retention policy are purged by batches, run is limited in time (remaining rows
+// are purged by next run)
+bool Database::applyRetention(const QSqlDatabase * userConnection, const QSqlDatabase * systemConnection,
+                              int & purgedRows) {
+
+    purgedRows = 0;
+    if (this->_retentionPolicy._keepDays <= 0)
+        return true;
+
+    // times in log are times of tracked server => cutoff is computed by its clock
+    // (row without end time is aged by its begin time or time when it was stored)
+    RetentionCutoffRow cutoffRow;
+    const QVector<QPair<QString, QString>> cutoffBindings
+      { qMakePair<QString, QString>(QStringLiteral(":keepDays"),
+                                    QString::number(this->_retentionPolicy._keepDays)) };
+
+    Query * const cutoffQuery = new Query(userConnection, cutoffBindings);
+    const bool cutoffLoaded =
+        cutoffQuery->prepareQuery(QStringLiteral(":/query/sql/master/retrieve_retention_cutoff.sql")) &&
+        cutoffQuery->selectFirstRow(mapColumns(&RetentionCutoffRow::_cutoff), cutoffRow) &&
+        cutoffRow._cutoff.isValid();
+    delete cutoffQuery;
+
+    if (!cutoffLoaded)
+        return false;
+
+    return this->purgeTrackedRows(systemConnection, cutoffRow._cutoff, this->_retentionPolicy._hourlyRollup,
+                                  sql::retentionRunDuration, sql::retentionBatchPause, purgedRows);
+}
+
+// rows of database in shared table are deleted by batches before its record is removed (cascade
+// would delete all of them in one statement with the record), own table is dropped as a whole
+bool Database::purgeLogTableOfThisDB(const QSqlDatabase * systemConnection) {
+
+    if (this->_trackingStorage->mode() != TrackingStorage::SHARED_TABLE)
+        return true;
+
+    // every row is older than cutoff, nothing is summarized and nobody waits for next batch
+    int purgedRows = 0;
+    return this->purgeTrackedRows(systemConnection, QDateTime(QDate(9999, 12, 31), QTime(0, 0)), false,
+                                  0, 0, purgedRows);
+}
+
+// rows older than cutoff are purged in order of clustered key (EndLSN) by small batches;
+// batch = rollup + delete of images and rows in one short transaction of system database,
+// pause between batches keeps locks and log writes of system database low while harvest and UI
+// read it [ms]; run ends after given duration [ms] (0 = when all rows are purged)
+bool Database::purgeTrackedRows(const QSqlDatabase * systemConnection, const QDateTime & cutoff,
+                                const bool hourlyRollup, const int runDuration, const int batchPause,
+                                int & purgedRows) {
+
+    QElapsedTimer timer;
+    timer.start();
+
+    purgedRows = 0;
+    QSqlDatabase connection = QSqlDatabase::database(systemConnection->connectionName());
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->logTableName()),
+        qMakePair<QString, QString>(QStringLiteral(":imageTableName"), this->logImageTableName()),
+        qMakePair<QString, QString>(QStringLiteral(":batchSize"), QString::number(sql::retentionBatchSize)) };
+
+    // statements of batch share range of keys (begin exclusive, end inclusive) and cutoff
+    const auto executeBatchStatement = [this, systemConnection, &customBindings, &cutoff]
+        (const QString & resourceForQuery, const LSN & batchBegin, const LSN & batchEnd, int & noOfRows) -> bool {
+
+            Query * const queryToExecute = new Query(systemConnection, customBindings);
+            queryToExecute->setClause(QStringLiteral(":trackedRows"), this->trackedRows());
+            bool dataModified = queryToExecute->prepareQuery(resourceForQuery);
+
+            if (dataModified) {
+
+                queryToExecute->setBinding(0, QVariant(batchBegin.toBinary()));
+                queryToExecute->setBinding(1, QVariant(batchEnd.toBinary()));
+                queryToExecute->setBinding(2, QVariant(cutoff));
+                dataModified = queryToExecute->processModifyQuery();
+                noOfRows = queryToExecute->noOfRowsAffected();
+            }
+            delete queryToExecute;
+            return dataModified;
+        };
+
+    LSN batchBegin = LSN();
+    bool dataModified = true;
+
+    while (dataModified && !this->cancelRequested() && (runDuration == 0 || timer.elapsed() < runDuration)) {
+
+        // last key of next batch (null = no rows older than cutoff left)
+        LastLSNRow batchEndRow;
+        Query * const queryToExecute = new Query(systemConnection, customBindings);
+        queryToExecute->setClause(QStringLiteral(":trackedRows"), this->trackedRows());
+
+        dataModified = queryToExecute->prepareQuery(QStringLiteral(":/query/sql/retrieve_retention_batch_end.sql"));
+        if (dataModified) {
+
+            queryToExecute->setBinding(0, QVariant(batchBegin.toBinary()));
+            queryToExecute->setBinding(1, QVariant(cutoff));
+            dataModified = queryToExecute->processSelectQuery(mapColumns(&LastLSNRow::_lastLSN),
+                [&batchEndRow](const LastLSNRow & row) -> bool { batchEndRow = row; return false; });
+        }
+        delete queryToExecute;
+
+        if (!dataModified || batchEndRow._lastLSN.isNull())
+            break;
+
+        int rolledUpRows = 0, deletedImages = 0, deletedRows = 0;
+        dataModified = connection.transaction();
+
+        if (dataModified && hourlyRollup)
+            dataModified = executeBatchStatement(QStringLiteral(":/query/sql/rollup_tracking_batch.sql"),
+                                                 batchBegin, batchEndRow._lastLSN, rolledUpRows);
+        // images are found by ranges of purged transactions => deleted before rows
+        if (dataModified)
+            dataModified = executeBatchStatement(QStringLiteral(":/query/sql/purge_record_images_batch.sql"),
+                                                 batchBegin, batchEndRow._lastLSN, deletedImages);
+        if (dataModified)
+            dataModified = executeBatchStatement(QStringLiteral(":/query/sql/purge_tracking_batch.sql"),
+                                                 batchBegin, batchEndRow._lastLSN, deletedRows);
+
+        if (dataModified) {
+
+            dataModified = connection.commit();
+            if (dataModified)
+                purgedRows += deletedRows;
+        }
+        else
+            connection.rollback();
+
+        batchBegin = batchEndRow._lastLSN;
+        if (batchPause > 0)
+            QThread::msleep(batchPause);
+    }
+
+    return (dataModified && !this->cancelRequested());
+}
+
+bool Database::saveConfiguration(const QSqlDatabase * systemConnection) {
+
+    // check if database DB corresponds to its name
+    if (!this->checkIfNameMatchesID())
+        return false;
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/update_db_connection_settings.sql");
+    bool dataModified = false;
+
+    Query * const queryToExecute = new Query(systemConnection);
+    if (queryToExecute->prepareQuery(resourceForQuery)) {
+
+        queryToExecute->setAllBindingsForProps(this->connectionProperties());
+        queryToExecute->setBinding(QStringLiteral(":id"), this->ID().toString(QUuid::WithoutBraces));
+        dataModified = queryToExecute->processModifyQuery();
+    }
+    delete queryToExecute;
+    return dataModified;
+}
+
+bool Database::retrieveSettings(const QSqlDatabase * userConnection,
+                                QMap<dbSettings, QString> & dbSettings) const {
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/master/dbstatus.sql");
+    bool dataAcquired = false;
+
+    Query * const queryToExecute = new Query(userConnection);
+    if (queryToExecute->prepareQuery(resourceForQuery)) {
+
+        queryToExecute->setBinding(QStringLiteral(":dbName"), this->dbName());
+
+        DatabaseSettingsRow settings;
+        dataAcquired = queryToExecute->selectFirstRow(mapColumns(&DatabaseSettingsRow::_lastFullBackup,
+            &DatabaseSettingsRow::_lastDiffBackup, &DatabaseSettingsRow::_lastLogBackup,
+            &DatabaseSettingsRow::_recoveryModel, &DatabaseSettingsRow::_state), settings);
+
+        if (dataAcquired) {
+
+            dbSettings.insert(LAST_FULL_BACKUP, settings._lastFullBackup);
+            dbSettings.insert(LAST_DIFF_BACKUP, settings._lastDiffBackup);
+            dbSettings.insert(LAST_LOG_BACKUP, settings._lastLogBackup);
+            dbSettings.insert(RECOVERY_MODEL, settings._recoveryModel);
+            dbSettings.insert(STATE, settings._state);
         }
     }
     delete queryToExecute;
@@ -6,48 +6,145 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include <functional>
+#include <QAtomicInt>
+#include <QByteArray>
 #include <QDateTime>
 #include <QMap>
 #include <QSqlDatabase>
 #include <QSqlError>
-#include <QSqlTableModel>
 #include <QString>
 #include <QUuid>
 #include <QVariant>
 #include <QVector>
 #include "constants.h"
+#include "logstore.h"
+#include "logfilter.h"
+#include "lsn.h"
+#include "objectnamecache.h"
+#include "odbcreader.h"
+#include "spscqueue.h"
+#include "trackingstorage.h"
 
 static struct LogTableLabels {
 
     const QString _prefix = QStringLiteral("Track_DB_");
     const QString _foreignKeyName =
         QStringLiteral("FK_[tableName]_DatabaseID_TrackedDatabases_ID");
+    const QString _imageSuffix = QStringLiteral("_Images");
+    const QString _sharedTableName = QStringLiteral("TrackedTransactions");
+    const int _noOfInsertedColumns = 9;
 
 } logTableLabels;
 
-class DatabaseLog {
+// rows older than _keepDays are purged from tracking table (summarized per hour and object first)
+struct RetentionPolicy {
 
-    public:
-        DatabaseLog();
-        DatabaseLog(const QString &, const QString &, const QString &, const QString &,
-                    const QDateTime &, const QDateTime &, const QString &, const QString &);
-        ~DatabaseLog() {}
+    int _keepDays = 0; // 0 = rows are kept
+    bool _hourlyRollup = true;
+};
 
-        QString transactionName() const { return _transactionName; }
-        QString transactionID() const { return _transactionID; }
-        QDateTime beginTime() const { return _beginTime; }
-        QDateTime endTime() const { return _endTime; }
-        QString userName() const { return _userName; }
+struct IngestStatistics {
 
-    private:
-        QString _objectName;
-        QString _operation;
-        QString _transactionName;
-        QString _transactionID;
-        QDateTime _beginTime;
-        QDateTime _endTime;
-        QString _description;
-        QString _userName;
+    int _rows = 0;
+    int _batches = 0;
+    int _statements = 0;
+    int _duplicates = 0; // transactions stored already (log read again from watermark)
+    qint64 _elapsed = 0; // [ns]
+
+    double rowsPerSecond() const
+        { return (_elapsed > 0) ? (_rows * 1000000000.0 / _elapsed) : 0.0; }
+};
+
+// log record whose object name is resolved after the log has been read
+struct UnresolvedRecord {
+
+    int _record;
+    qint64 _allocationUnitID;
+    QString _transactionID;
+};
+typedef QVector<UnresolvedRecord> UnresolvedRecords;
+
+// decoded row of log query (columns in order of select list), images are selected only
+// by projection profiles which harvest them
+struct LogRecordRow {
+
+    qint64 _allocationUnitID;
+    QString _operation;
+    QString _transactionName;
+    QString _transactionID;
+    QDateTime _beginTime;
+    QDateTime _endTime;
+    QString _userName;
+    LSN _currentLSN;
+    QByteArray _rowLogContents0;
+    QByteArray _rowLogContents1;
+    QByteArray _logRecord;
+};
+
+// images of one data record (columns not in projection profile are empty)
+struct LogRecordImage {
+
+    LSN _currentLSN;
+    QString _transactionID;
+    qint64 _allocationUnitID = 0;
+    QString _operation;
+    QByteArray _rowLogContents0;
+    QByteArray _rowLogContents1;
+    QByteArray _logRecord;
+};
+
+// log backup of database (msdb.backupset), cached in system database; records of file
+// are in range [_firstLSN, _lastLSN)
+struct LogBackupFile {
+
+    int _backupSetID;
+    LSN _firstLSN;
+    LSN _lastLSN;
+    QDateTime _finished;
+    QString _fileName;
+};
+
+// log backups which have to be read before active log (log was truncated after watermark)
+struct LogBackupPlan {
+
+    QVector<LogBackupFile> _files;
+    bool _activeLogTruncated = false;
+};
+
+// how far log of database was harvested: log up to watermark is fully covered by stored transactions
+// (harvest resumes after it), all transactions committed up to scanned LSN are stored
+struct HarvestPosition {
+
+    LSN _watermark;
+    LSN _scannedLSN;
+};
+
+// values of one row of tracking table (one transaction)
+struct TrackedTransaction {
+
+    QString _objectName;
+    QString _transactionName;
+    QString _transactionID;
+    QDateTime _beginTime;
+    QDateTime _endTime;
+    QString _userName;
+    LSNRange _range;
+    int _noOfDataRecords = 0; // records other than begin/commit
+    HarvestPosition _position; // reached once this row is stored
+};
+
+// part of pending log range [_from, _to) read by its own connection (null _to = end of log)
+struct LogChunk {
+
+    LSN _from;
+    LSN _to;
+    CompiledLogFilter _filter;
+    LogRecordBuffer _records;
+    QVector<LogRecordImage> _images;
+    bool _finished = false; // guarded by mutex of Database::loadAllLogRecordsInParallel
+    bool _success = false;
+    QString _error;
 };
 
 class DatabaseConnectionProps {
@@ -86,9 +183,11 @@ class Database {
         enum dbSettings { LAST_FULL_BACKUP, LAST_DIFF_BACKUP, LAST_LOG_BACKUP,
                           RECOVERY_MODEL, STATE, END_OF_SETTINGS };
         enum dbPosition { NO_DB = 0, FIRST_DB, PREVIOUS_DB, NEXT_DB, LAST_DB };
-
-        inline void initializeLogTable(const QString & tableName)
-            { this->_logTable->setTable(tableName); this->_logTable->select(); return; }
+        enum progressStage { LOADING_LOG, UPDATING_TRACKING_TABLE };
+        enum logReader { QT_SQL_READER, NATIVE_ODBC_READER };
+        // columns harvested from log: metadata of transactions only, + row images
+        // ([RowLog Contents 0/1]), + whole record ([Log Record])
+        enum logProjection { METADATA_ONLY, ROW_IMAGES, FULL_RECORD };
 
         inline QUuid ID() const { return _ID; }
         inline int databaseID() const { return _databaseID; }
@@ -97,32 +196,126 @@ class Database {
         inline QString dbName() const { return _connectionProperties->dbName(); }
         inline DatabaseConnectionProps * connectionProperties() const { return _connectionProperties; }
         inline QSqlDatabase * dbConnection() const { return _dbConnection; }
-        inline QSqlTableModel * logTable() { return _logTable; }
+        inline int batchSize() const { return _batchSize; }
+        inline void setBatchSize(const int size) { _batchSize = (size > 0) ? size : sql::defaultBatchSize; return; }
+        inline const IngestStatistics & ingestStatistics() const { return _ingestStatistics; }
+        // log queries and statement limits can be switched for a stand-in server (benchmark)
+        inline void setLogQueryResources(const QString & path) { _logQueryResources = path; return; }
+        inline void setMaxParametersPerStatement(const int maxParameters)
+            { _maxParametersPerStatement = maxParameters; return; }
+        // fn_dblog can be read by native ODBC reader (if built with it), QtSql is used otherwise
+        inline void setLogReader(const logReader reader) { _logReader = reader; return; }
+        // pending log range spanning several VLFs is read by up to N connections at the same time
+        inline int scanConcurrency() const { return _scanConcurrency; }
+        inline void setScanConcurrency(const int concurrency)
+            { _scanConcurrency = (concurrency > 0) ? concurrency : sql::defaultScanConcurrency; return; }
+        // fetch, grouping and persisting run at the same time, connected by bounded queues
+        inline bool pipelinedHarvest() const { return _pipelinedHarvest; }
+        inline void setPipelinedHarvest(const bool pipelined) { _pipelinedHarvest = pipelined; return; }
+        // filter and retention policy of database (loaded with list of tracked databases)
+        inline LogFilter & logFilter() { return _logFilter; }
+        inline const LogFilter & logFilter() const { return _logFilter; }
+        inline RetentionPolicy & retentionPolicy() { return _retentionPolicy; }
+        inline const RetentionPolicy & retentionPolicy() const { return _retentionPolicy; }
+        // images are kept in separate table (tracking table always holds metadata only)
+        inline logProjection projection() const { return _projection; }
+        inline void setProjection(const logProjection projection) { _projection = projection; return; }
+        inline logReader activeLogReader() const
+            { return (_logReader == NATIVE_ODBC_READER && OdbcBulkReader::isAvailable())
+                     ? NATIVE_ODBC_READER : QT_SQL_READER; }
+
+        // long-running operations (load/update) report progress and can be cancelled from other thread
+        inline void setProgressHandler(const std::function<void(const progressStage, const int)> & handler)
+            { _progressHandler = handler; return; }
+        inline void requestCancel() { _cancelRequested.storeRelease(1); return; }
+        inline void resetCancel() { _cancelRequested.storeRelease(0); return; }
+        inline bool cancelRequested() const { return (_cancelRequested.loadAcquire() != 0); }
 
-        inline QString logTableName() const
-            { return (logTableLabels._prefix + _ID.toString(QUuid::WithoutBraces)); }
-        inline QString logTableForeignKey() const
-            {  QString foreignKeyTemplate = logTableLabels._foreignKeyName;
-               return (foreignKeyTemplate.replace("[tableName]", this->logTableName())); }
+        // tracked transactions are kept in table of their own or in table shared by all databases
+        inline const TrackingStorage * trackingStorage() const { return _trackingStorage; }
+        inline void setTrackingStorage(const TrackingStorage * storage) { _trackingStorage = storage; return; }
+        inline QString logTableName() const { return _trackingStorage->tableName(_ID); }
+        inline QString trackedRows() const { return _trackingStorage->rowsOfDatabase(_ID); }
+        inline QString logImageTableName() const
+            { return (logTableLabels._prefix + _ID.toString(QUuid::WithoutBraces) + logTableLabels._imageSuffix); }
         inline void deleteDbID() { _databaseID = -1 /* behaves as new */; return; }
 
         bool loadNewDatabaseID();
         bool isDbAlreadyTracked(const QSqlDatabase *) const;
         bool addRecordToTrackingTable(const QSqlDatabase *);
         bool removeRecordFromTrackingTable(const QSqlDatabase *);
-        const QString retrieveLastLSNFromTrackingTable() const;
-        bool loadAllLogRecordsFromGivenLSN(const QString &);
+        // watermark = last LSN durably stored in tracking table (kept in system database)
+        static bool createWatermarkTable(const QSqlDatabase *);
+        static bool createLogFilterTable(const QSqlDatabase *);
+        static bool createLogBackupTable(const QSqlDatabase *);
+        static bool createRetentionTables(const QSqlDatabase *);
+        const LSN retrieveLastLSNFromTrackingTable(const QSqlDatabase *) const;
+        // backups are read only if active log does not contain all records after given LSN
+        bool planLogBackups(const QSqlDatabase *, const QSqlDatabase *, const LSN &);
+        inline const LogBackupPlan & logBackupPlan() const { return _logBackupPlan; }
+        inline bool loadAllLogRecordsFromGivenLSN(const LSN & fromLSN)
+            { return loadAllLogRecordsFromGivenLSN(this->_dbConnection, fromLSN); }
+        bool loadAllLogRecordsFromGivenLSN(const QSqlDatabase *, const LSN &);
+        bool loadLogChunk(const QSqlDatabase *, LogChunk &) const;
+        inline int noOfLoadedTransactions() const
+            { return (_logContents != nullptr) ? _logContents->noOfTransactions() : 0; }
+        inline qint64 loadedLogMemoryUsage() const
+            { return (_logContents != nullptr) ? _logContents->memoryUsage() : 0; }
+        // loaded log is assembled afterwards => memory grows with pending range (not bounded,
+        // unlike pipelined harvest)
         bool updateTrackingTableWithLogData(const QSqlDatabase *);
+        // load and update in one pass (log is not kept in memory)
+        bool harvestLogPipelined(const QSqlDatabase *, const QSqlDatabase *, const LSN &);
+        // images captured while log was loaded from given LSN (according to projection profile)
+        bool storeCapturedImages(const QSqlDatabase *, const LSN &);
+        // images of one stored transaction: from image table, from log if they were not harvested
+        bool loadTransactionImages(const QSqlDatabase *, const QSqlDatabase *, const QString &,
+                                   const LSNRange &, QVector<LogRecordImage> &) const;
         bool createLogTableForThisDB(const QSqlDatabase *);
+        bool logTableNeedsMigration(const QSqlDatabase *, bool &) const;
+        bool migrateLogTableOfThisDB(const QSqlDatabase *);
         bool dropLogTableOfThisDB(const QSqlDatabase *);
+        // number of purged rows is returned
+        bool applyRetention(const QSqlDatabase *, const QSqlDatabase *, int &);
+        // rows of removed database are purged before its record is removed (shared table only)
+        bool purgeLogTableOfThisDB(const QSqlDatabase *);
         void connectionResult(const bool result) { _connectionEstablished = result; return; }
 
+        void setConnectionString(const DatabaseConnectionProps * const) const;
         bool connectToServer(const DatabaseConnectionProps * const, QSqlError &) const;
+        bool openConnection() const;
         bool saveConfiguration(const QSqlDatabase *);
-        bool retrieveSettings(QMap<dbSettings, QString> &) const;
+        inline bool retrieveSettings(QMap<dbSettings, QString> & dbSettings) const
+            { return retrieveSettings(this->_dbConnection, dbSettings); }
+        bool retrieveSettings(const QSqlDatabase *, QMap<dbSettings, QString> &) const;
 
     private:
         bool checkIfNameMatchesID() const;
+        bool loadAllLogRecordsNatively(const QSqlDatabase *, const QString &, const LSN &);
+        QVector<LSN> splitLogOnVlfBoundaries(const QSqlDatabase *, const LSN &) const;
+        bool loadAllLogRecordsInParallel(const QSqlDatabase *, const QVector<LSN> &, const LSN &);
+        QString objectName(const qint64, const QString &, const QString &, UnresolvedRecords &);
+        bool resolveObjectNames(const QSqlDatabase *, const UnresolvedRecords &);
+        bool purgeTrackedRows(const QSqlDatabase *, const QDateTime &, const bool, const int, const int,
+                              int &);
+        bool refreshLogBackupCatalog(const QSqlDatabase *, const QSqlDatabase *) const;
+        const LSN retrieveFirstActiveLSN(const QSqlDatabase *) const;
+        bool readLogBackup(const QSqlDatabase *, const LogBackupFile &, const CompiledLogFilter &,
+                           const std::function<bool(const LogRecordRow &)> &) const;
+        bool fetchLogRecords(const QSqlDatabase *, const QSqlDatabase *, const LSN &,
+                             const CompiledLogFilter &, SpscQueue<LogRecordRow> &);
+        bool groupLogRecords(SpscQueue<LogRecordRow> &, SpscQueue<TrackedTransaction> &,
+                             const QString &, const HarvestPosition &, HarvestPosition &);
+        bool persistTrackedTransactions(SpscQueue<TrackedTransaction> &, const QString &,
+                                        const HarvestPosition &);
+        const LSN retrieveScannedLSN(const QSqlDatabase *) const;
+        bool advanceWatermark(const QSqlDatabase *, const HarvestPosition &) const;
+        bool createLogImageTable(const QSqlDatabase *) const;
+        bool prepareLogImageTable(const QSqlDatabase *, const LSN &) const;
+        bool storeRecordImages(const QSqlDatabase *, const QVector<LogRecordImage> &) const;
+        bool deleteRecordImages(const QSqlDatabase *, const QString &, const LSN &) const;
+        inline void reportProgress(const progressStage stage, const int done) const
+            { if (_progressHandler) _progressHandler(stage, done); return; }
 
         const QUuid _ID;
         int _databaseID;
@@ -131,8 +324,24 @@ class Database {
         bool _connectionEstablished;
         DatabaseConnectionProps * _connectionProperties;
         QSqlDatabase * _dbConnection;
-        QMap<QString, QVector<DatabaseLog>> * _logContents;
-        QSqlTableModel * _logTable;
+        LogStore * _logContents;
+        QVector<LogRecordImage> _capturedImages; // images of records in _logContents
+        LSN _loadedFromLSN; // log in _logContents was read from this LSN
+        LogBackupPlan _logBackupPlan;
+        ObjectNameCache * _objectNames;
+        LogFilter _logFilter;
+        RetentionPolicy _retentionPolicy;
+        int _batchSize;
+        IngestStatistics _ingestStatistics;
+        QString _logQueryResources;
+        int _maxParametersPerStatement;
+        logReader _logReader;
+        int _scanConcurrency;
+        bool _pipelinedHarvest;
+        logProjection _projection;
+        const TrackingStorage * _trackingStorage;
+        std::function<void(const progressStage, const int)> _progressHandler;
+        QAtomicInt _cancelRequested;
 };
 
 #endif // DATABASE_H
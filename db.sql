@@ -6,7 +6,53 @@ CREATE TABLE TrackedDatabases
 INSERT INTO TrackedDatabases
   VALUES (NEWID(), CURRENT_TIMESTAMP, '.', 11, 'S5_System_Etalon_test_F', '1433', 'web'); 
 
+-- clustered by commit LSN (rows are appended in order of commits, transaction stored twice violates key)
 CREATE TABLE [Track_DB_73F72078-01D8-4FDC-B617-AF70460B0DF1]
-  (ID uniqueidentifier PRIMARY KEY, DatabaseID uniqueidentifier not null, Create_Date datetime, CurrentLSN nvarchar not null, Operation nvarchar not null, Context nvarchar not null,
-   TransactionID nvarchar not null, LogRecordLength smallint not null, PreviousLSN nvarchar not null, TransactionSID varbinary null, LogRecord varbinary not null,
+  (ID bigint IDENTITY(1, 1) NOT NULL, DatabaseID uniqueidentifier NOT NULL, Create_Date datetime NOT NULL DEFAULT CURRENT_TIMESTAMP, ObjectName nvarchar(256) NULL,
+   Operation nvarchar(60) NULL, TransactionID nvarchar(20) NOT NULL, BeginTime datetime NULL, EndTime datetime NULL, UserName nvarchar(128) NULL, BeginLSN binary(10) NOT NULL, EndLSN binary(10) NOT NULL,
+   PRIMARY KEY CLUSTERED (EndLSN),
    CONSTRAINT FK_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID) REFERENCES TrackedDatabases(ID));
+
+CREATE INDEX IX_TransactionID ON [Track_DB_73F72078-01D8-4FDC-B617-AF70460B0DF1] (TransactionID) INCLUDE (BeginLSN);
+CREATE INDEX IX_EndTime ON [Track_DB_73F72078-01D8-4FDC-B617-AF70460B0DF1] (EndTime)
+  INCLUDE (ObjectName, Operation, TransactionID, BeginTime, UserName, BeginLSN);
+
+-- alternative to table per database (harvest with --shared-table), rows of all databases
+CREATE TABLE TrackedTransactions
+  (ID bigint IDENTITY(1, 1) NOT NULL, DatabaseID uniqueidentifier NOT NULL, Create_Date datetime NOT NULL DEFAULT CURRENT_TIMESTAMP, ObjectName nvarchar(256) NULL,
+   Operation nvarchar(60) NULL, TransactionID nvarchar(20) NOT NULL, BeginTime datetime NULL, EndTime datetime NULL, UserName nvarchar(128) NULL, BeginLSN binary(10) NOT NULL, EndLSN binary(10) NOT NULL,
+   CONSTRAINT PK_TrackedTransactions PRIMARY KEY CLUSTERED (DatabaseID, EndLSN),
+   CONSTRAINT FK_TrackedTransactions_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID) REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
+
+CREATE INDEX IX_TransactionID ON TrackedTransactions (DatabaseID, TransactionID) INCLUDE (BeginLSN);
+CREATE INDEX IX_EndTime ON TrackedTransactions (EndTime)
+  INCLUDE (DatabaseID, ObjectName, Operation, TransactionID, BeginTime, UserName, BeginLSN);
+
+-- rows older than KeepDays are purged after harvest (summarized per hour and object if HourlyRollup = 1)
+CREATE TABLE RetentionPolicies
+  (DatabaseID uniqueidentifier NOT NULL PRIMARY KEY, KeepDays int NOT NULL CHECK (KeepDays > 0), HourlyRollup bit NOT NULL DEFAULT 1,
+   CONSTRAINT FK_RetentionPolicies_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID) REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
+
+CREATE TABLE HourlyTransactionSummary
+  (DatabaseID uniqueidentifier NOT NULL, HourStart datetime NOT NULL, ObjectName nvarchar(256) NOT NULL, NoOfTransactions int NOT NULL, LastLSN binary(10) NOT NULL,
+   CONSTRAINT PK_HourlyTransactionSummary PRIMARY KEY (DatabaseID, HourStart, ObjectName),
+   CONSTRAINT FK_HourlyTransactionSummary_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID) REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
+
+-- only for projection profiles with images (LogRecord only for full record profile)
+CREATE TABLE [Track_DB_73F72078-01D8-4FDC-B617-AF70460B0DF1_Images]
+  (CurrentLSN binary(10) NOT NULL PRIMARY KEY, TransactionID nvarchar(20) NOT NULL, AllocUnitId bigint NOT NULL, Operation nvarchar(60) NOT NULL,
+   RowLogContents0 varbinary(max) NULL, RowLogContents1 varbinary(max) NULL, LogRecord varbinary(max) NULL);
+
+CREATE TABLE HarvestWatermarks
+  (DatabaseID uniqueidentifier NOT NULL PRIMARY KEY, LastLSN binary(10) NOT NULL, ScannedLSN binary(10) NULL, UpdatedAt datetime NOT NULL DEFAULT CURRENT_TIMESTAMP,
+   CONSTRAINT FK_HarvestWatermarks_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID) REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
+
+CREATE TABLE LogBackups
+  (DatabaseID uniqueidentifier NOT NULL, BackupSetID int NOT NULL, FirstLSN binary(10) NOT NULL, LastLSN binary(10) NOT NULL, BackupFinished datetime NULL, FileName nvarchar(260) NOT NULL,
+   CONSTRAINT PK_LogBackups PRIMARY KEY (DatabaseID, BackupSetID),
+   CONSTRAINT FK_LogBackups_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID) REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
+
+CREATE TABLE LogFilters
+  (ID int IDENTITY(1, 1) PRIMARY KEY, DatabaseID uniqueidentifier NOT NULL, FilterType nvarchar(20) NOT NULL, Pattern nvarchar(256) NOT NULL, Excluded bit NOT NULL DEFAULT 0,
+   CONSTRAINT CK_LogFilters_FilterType CHECK (FilterType IN (N'Operation', N'Context', N'Object', N'User')),
+   CONSTRAINT FK_LogFilters_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID) REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
@@ -0,0 +1,166 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include "dbworker.h"
+
+DatabaseWorker::DatabaseWorker(Database * database, const QString & systemConnectionName):
+    QObject(nullptr), _database(database), _systemConnectionName(systemConnectionName),
+    _userConnection(nullptr), _systemConnection(nullptr) {}
+
+// deleted in worker thread (connections are removed by the thread which created them)
+DatabaseWorker::~DatabaseWorker() {
+
+    delete _userConnection;
+    delete _systemConnection;
+}
+
+QMap<Database::dbSettings, QString> DatabaseWorker::settingsFromList(const QStringList & settingsList) {
+
+    QMap<Database::dbSettings, QString> dbSettings;
+    for (int i = 0; i < settingsList.size() && i != int(Database::END_OF_SETTINGS); ++i)
+        dbSettings.insert((Database::dbSettings)i, settingsList.at(i));
+
+    return dbSettings;
+}
+
+QStringList DatabaseWorker::settingsToList(bool & settingsLoaded) const {
+
+    QMap<Database::dbSettings, QString> dbSettings;
+    settingsLoaded = this->_database->retrieveSettings(this->_userConnection->connection(), dbSettings);
+
+    QStringList settingsList;
+    for (int i = (int)Database::LAST_FULL_BACKUP; i != int(Database::END_OF_SETTINGS); ++i)
+        settingsList << dbSettings.value((Database::dbSettings)i);
+
+    return settingsList;
+}
+
+// connections are (re)created from current connection strings of the main thread connections
+bool DatabaseWorker::openConnections(QString & error) {
+
+    if (this->_userConnection == nullptr || !this->_userConnection->isOpen()) {
+
+        delete this->_userConnection;
+        this->_userConnection = new ThreadConnection(this->_database->connectionName());
+    }
+    if (this->_systemConnection == nullptr || !this->_systemConnection->isOpen()) {
+
+        delete this->_systemConnection;
+        this->_systemConnection = new ThreadConnection(this->_systemConnectionName);
+    }
+
+    if (!this->_userConnection->isOpen())
+        error = this->_userConnection->lastError();
+    else if (!this->_systemConnection->isOpen())
+        error = this->_systemConnection->lastError();
+
+    return (this->_userConnection->isOpen() && this->_systemConnection->isOpen());
+}
+
+// [slot]
+void DatabaseWorker::connectToServer() {
+
+    // connection string may have changed => always reconnect
+    delete this->_userConnection;
+    this->_userConnection = nullptr;
+
+    QString error = QString();
+    bool settingsLoaded = false;
+    QStringList settingsList;
+
+    const bool connectionEstablished = this->openConnections(error);
+    if (connectionEstablished)
+        settingsList = this->settingsToList(settingsLoaded);
+
+    emit connected(connectionEstablished && settingsLoaded, error, settingsList);
+    return;
+}
+
+// [slot]
+void DatabaseWorker::retrieveSettings() {
+
+    QString error = QString();
+    bool settingsLoaded = false;
+    QStringList settingsList;
+
+    if (this->openConnections(error))
+        settingsList = this->settingsToList(settingsLoaded);
+
+    emit settingsRetrieved(settingsLoaded, settingsList);
+    return;
+}
+
+// [slot]
+void DatabaseWorker::refresh() {
+
+    QString error = QString();
+    bool dbTrackingRefreshed = false;
+
+    this->_database->resetCancel();
+    this->_database->setProgressHandler(
+        [this](const Database::progressStage stage, const int done) -> void
+            { emit progress(int(stage), done); });
+
+    if (this->openConnections(error)) {
+
+        // retrieve last tracked LSN
+        const LSN lastLSN =
+            this->_database->retrieveLastLSNFromTrackingTable(this->_systemConnection->connection());
+
+        // load data from log (log backups first if log was truncated) and update tracking table with it
+        if (this->_database->planLogBackups(this->_userConnection->connection(),
+                                            this->_systemConnection->connection(), lastLSN) &&
+            this->_database->loadAllLogRecordsFromGivenLSN(this->_userConnection->connection(), lastLSN))
+            dbTrackingRefreshed =
+                this->_database->updateTrackingTableWithLogData(this->_systemConnection->connection()) &&
+                this->_database->storeCapturedImages(this->_systemConnection->connection(), lastLSN);
+    }
+
+    this->_database->setProgressHandler(nullptr);
+
+    const IngestStatistics & statistics = this->_database->ingestStatistics();
+    emit refreshed(dbTrackingRefreshed, this->_database->cancelRequested(),
+                   this->_database->noOfLoadedTransactions(), statistics._rows,
+                   statistics.rowsPerSecond());
+    return;
+}
+
+// [slot] tracking table of older layout is rebuilt outside of GUI thread (one transaction)
+void DatabaseWorker::migrateLogTable() {
+
+    QString error = QString();
+    bool tableMigrated = false;
+
+    if (this->openConnections(error))
+        tableMigrated = this->_database->migrateLogTableOfThisDB(this->_systemConnection->connection());
+
+    emit migrated(tableMigrated);
+    return;
+}
+
+// [slot] images of transaction selected in tracking table (LSNs as shown in table)
+void DatabaseWorker::loadTransactionImages(const QString & transactionID, const QString & beginLSN,
+                                           const QString & endLSN) {
+
+    QString error = QString();
+    QVector<LogRecordImage> images;
+    bool imagesLoaded = false;
+
+    if (this->openConnections(error))
+        imagesLoaded = this->_database->loadTransactionImages(this->_userConnection->connection(),
+            this->_systemConnection->connection(), transactionID,
+            LSNRange(LSN::fromString(beginLSN), LSN::fromString(endLSN)), images);
+
+    QString imagesText;
+    for (const auto & it : images)
+        imagesText += it._currentLSN.toString() + QStringLiteral("  ") + it._operation +
+            QStringLiteral("  ") + QString::number(it._allocationUnitID) +
+            QStringLiteral("\n  RowLog Contents 0: ") + QString::fromLatin1(it._rowLogContents0.toHex()) +
+            QStringLiteral("\n  RowLog Contents 1: ") + QString::fromLatin1(it._rowLogContents1.toHex()) +
+            QStringLiteral("\n  Log Record: ") + QString::fromLatin1(it._logRecord.toHex()) + QStringLiteral("\n");
+
+    emit transactionImagesLoaded(imagesLoaded, imagesText);
+    return;
+}
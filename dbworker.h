@@ -0,0 +1,54 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef DBWORKER_H
+#define DBWORKER_H
+
+#include <QMap>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include "database.h"
+#include "harvest.h"
+
+// network operations of one database executed in a dedicated thread (one worker per connection),
+// slots are invoked by queued calls, results are delivered back by signals
+class DatabaseWorker: public QObject {
+
+    Q_OBJECT
+
+    public:
+        DatabaseWorker(Database *, const QString &);
+        ~DatabaseWorker();
+
+        // settings in order of Database::dbSettings
+        static QMap<Database::dbSettings, QString> settingsFromList(const QStringList &);
+
+    public slots:
+        void connectToServer();
+        void retrieveSettings();
+        void refresh();
+        void migrateLogTable();
+        void loadTransactionImages(const QString &, const QString &, const QString &);
+
+    signals:
+        void connected(const bool, const QString &, const QStringList &);
+        void settingsRetrieved(const bool, const QStringList &);
+        void progress(const int, const int);
+        void refreshed(const bool, const bool, const int, const int, const double);
+        void migrated(const bool);
+        void transactionImagesLoaded(const bool, const QString &);
+
+    private:
+        bool openConnections(QString &);
+        QStringList settingsToList(bool &) const;
+
+        Database * const _database;
+        const QString _systemConnectionName;
+        ThreadConnection * _userConnection;
+        ThreadConnection * _systemConnection;
+};
+
+#endif // DBWORKER_H
@@ -0,0 +1,136 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QThread>
+#include "harvest.h"
+#include "statementcache.h"
+
+ThreadConnection::ThreadConnection(const QString & connectionName):
+    _cloneName(connectionName + sql::threadConnectionSuffix +
+               QString::number(reinterpret_cast<quintptr>(QThread::currentThreadId()))) {
+
+    _connection = QSqlDatabase::cloneDatabase(connectionName, this->_cloneName);
+    _connection.open();
+}
+
+ThreadConnection::~ThreadConnection() {
+
+    // cached statements hold the connection => must be released before it is removed
+    StatementCache::invalidate(this->_cloneName);
+    _connection.close();
+    _connection = QSqlDatabase();
+    QSqlDatabase::removeDatabase(this->_cloneName);
+}
+
+HarvestTask::HarvestTask(Database * database, const QString & systemConnectionName,
+                         QVector<HarvestResult> * results, QMutex * resultsMutex):
+    _database(database), _systemConnectionName(systemConnectionName), _results(results),
+    _resultsMutex(resultsMutex) {
+
+    this->setAutoDelete(true);
+}
+
+void HarvestTask::run() {
+
+    QElapsedTimer timer;
+    timer.start();
+
+    HarvestResult result;
+    result._ID = this->_database->ID();
+    result._dbName = this->_database->dbName();
+
+    {
+        const ThreadConnection userConnection(this->_database->connectionName());
+        const ThreadConnection systemConnection(this->_systemConnectionName);
+
+        if (!userConnection.isOpen())
+            result._error = userConnection.lastError();
+        else if (!systemConnection.isOpen())
+            result._error = systemConnection.lastError();
+        else {
+
+            // retrieve last tracked LSN
+            const LSN lastLSN =
+                this->_database->retrieveLastLSNFromTrackingTable(systemConnection.connection());
+
+            // records missing in active log are read from log backups first
+            if (!this->_database->planLogBackups(userConnection.connection(), systemConnection.connection(),
+                                                 lastLSN))
+                result._error = QStringLiteral("Nepodařilo se určit zálohy logu ke zpracování.");
+            // log is streamed into tracking table
+            else if (this->_database->pipelinedHarvest()) {
+
+                result._success = this->_database->harvestLogPipelined(userConnection.connection(),
+                    systemConnection.connection(), lastLSN);
+                result._ingestStatistics = this->_database->ingestStatistics();
+                result._transactions = result._ingestStatistics._rows;
+
+                if (!result._success)
+                    result._error = QStringLiteral("Nepodařilo se zpracovat záznamy z logu.");
+            }
+            // load data from log and update tracking table with it
+            else if (this->_database->loadAllLogRecordsFromGivenLSN(userConnection.connection(), lastLSN)) {
+
+                result._transactions = this->_database->noOfLoadedTransactions();
+                result._success =
+                    this->_database->updateTrackingTableWithLogData(systemConnection.connection()) &&
+                    this->_database->storeCapturedImages(systemConnection.connection(), lastLSN);
+                result._ingestStatistics = this->_database->ingestStatistics();
+
+                if (!result._success)
+                    result._error = QStringLiteral("Nepodařilo se aktualizovat sledovací tabulku.");
+            }
+            else
+                result._error = QStringLiteral("Nepodařilo se načíst záznamy z logu.");
+
+            // rows older than retention policy are purged after harvest (by small batches)
+            if (result._success && !this->_database->applyRetention(userConnection.connection(),
+                    systemConnection.connection(), result._purgedRows)) {
+
+                result._success = false;
+                result._error = this->_database->cancelRequested()
+                    ? QStringLiteral("Odstraňování starých záznamů sledovací tabulky bylo přerušeno.")
+                    : QStringLiteral("Nepodařilo se odstranit staré záznamy sledovací tabulky.");
+            }
+        }
+    }
+
+    result._elapsed = timer.elapsed();
+
+    QMutexLocker locker(this->_resultsMutex);
+    this->_results->push_back(result);
+    return;
+}
+
+LogChunkTask::LogChunkTask(const Database * database, const QString & connectionName, LogChunk * chunk,
+                           QMutex * finishedMutex, QWaitCondition * chunkFinished):
+    _database(database), _connectionName(connectionName), _chunk(chunk),
+    _finishedMutex(finishedMutex), _chunkFinished(chunkFinished) {
+
+    this->setAutoDelete(true);
+}
+
+void LogChunkTask::run() {
+
+    const ThreadConnection userConnection(this->_connectionName);
+
+    if (!userConnection.isOpen())
+        this->_chunk->_error = userConnection.lastError();
+    else
+        this->_chunk->_success = this->_database->loadLogChunk(userConnection.connection(), *(this->_chunk));
+
+    QMutexLocker finishedLocker(this->_finishedMutex);
+    this->_chunk->_finished = true;
+    this->_chunkFinished->wakeAll();
+    return;
+}
+
+PipelineStageTask::PipelineStageTask(const std::function<void()> & stage): _stage(stage) {
+
+    this->setAutoDelete(true);
+}
@@ -0,0 +1,95 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef HARVEST_H
+#define HARVEST_H
+
+#include <functional>
+#include <QMutex>
+#include <QRunnable>
+#include <QSqlDatabase>
+#include <QString>
+#include <QUuid>
+#include <QVector>
+#include <QWaitCondition>
+#include "database.h"
+
+struct HarvestResult {
+
+    QUuid _ID;
+    QString _dbName;
+    bool _success = false;
+    int _transactions = 0;
+    IngestStatistics _ingestStatistics;
+    int _purgedRows = 0; // by retention policy
+    qint64 _elapsed = 0; // [ms]
+    QString _error;
+};
+
+// QSqlDatabase can be used only by the thread which created it =>
+// connection is cloned (and opened) in the calling thread and removed on destruction
+class ThreadConnection {
+
+    public:
+        explicit ThreadConnection(const QString &);
+        ~ThreadConnection();
+
+        inline bool isOpen() const { return _connection.isOpen(); }
+        inline const QSqlDatabase * connection() const { return &_connection; }
+        inline QString lastError() const { return _connection.lastError().text(); }
+
+    private:
+        const QString _cloneName;
+        QSqlDatabase _connection;
+};
+
+// retrieve LSN / load / persist cycle of one database executed on a worker thread
+class HarvestTask: public QRunnable {
+
+    public:
+        HarvestTask(Database *, const QString &, QVector<HarvestResult> *, QMutex *);
+        ~HarvestTask() {}
+
+        void run() override;
+
+    private:
+        Database * const _database;
+        const QString _systemConnectionName;
+        QVector<HarvestResult> * const _results;
+        QMutex * const _resultsMutex;
+};
+
+// one chunk of log range read by its own connection (see Database::loadAllLogRecordsInParallel)
+class LogChunkTask: public QRunnable {
+
+    public:
+        // finishing of chunk is signalled by given wait condition
+        LogChunkTask(const Database *, const QString &, LogChunk *, QMutex *, QWaitCondition *);
+        ~LogChunkTask() {}
+
+        void run() override;
+
+    private:
+        const Database * const _database;
+        const QString _connectionName;
+        LogChunk * const _chunk;
+        QMutex * const _finishedMutex;
+        QWaitCondition * const _chunkFinished;
+};
+
+// stage of pipelined harvest (see Database::harvestLogPipelined)
+class PipelineStageTask: public QRunnable {
+
+    public:
+        explicit PipelineStageTask(const std::function<void()> &);
+        ~PipelineStageTask() {}
+
+        void run() override { _stage(); return; }
+
+    private:
+        const std::function<void()> _stage;
+};
+
+#endif // HARVEST_H
@@ -0,0 +1,286 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include <cstring>
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QTextStream>
+#include <QTimer>
+#include "headless.h"
+#include "querystatistics.h"
+
+HeadlessHarvest::HeadlessHarvest(QObject * parent):
+    QObject(parent), _session(nullptr), _once(true), _interval(0),
+    _concurrency(sql::defaultHarvestConcurrency), _scanWorkers(sql::defaultScanConcurrency),
+    _batchSize(sql::defaultBatchSize),
+    _nativeOdbc(false), _pipeline(false), _sharedTable(false), _migrate(false),
+    _projection(Database::METADATA_ONLY), _lastExitCode(OK) {}
+
+HeadlessHarvest::~HeadlessHarvest() {
+
+    delete _session;
+}
+
+bool HeadlessHarvest::isRequested(int argc, char * argv[]) {
+
+    for (int i = 1; i < argc; ++i)
+        if (std::strcmp(argv[i], "--harvest") == 0)
+            return true;
+
+    return false;
+}
+
+bool HeadlessHarvest::parseArguments() {
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        QStringLiteral("Načte záznamy z logů sledovaných databází do systémové databáze."));
+    const QCommandLineOption helpOption = parser.addHelpOption();
+
+    const QCommandLineOption harvestOption(QStringLiteral("harvest"),
+        QStringLiteral("Spustit bez okna (pouze aktualizace sledovacích tabulek)."));
+    const QCommandLineOption onceOption(QStringLiteral("once"),
+        QStringLiteral("Provést jedinou aktualizaci a skončit."));
+    const QCommandLineOption intervalOption(QStringLiteral("interval"),
+        QStringLiteral("Opakovat aktualizaci každých N sekund."), QStringLiteral("N"));
+    const QCommandLineOption concurrencyOption(QStringLiteral("concurrency"),
+        QStringLiteral("Počet současně zpracovávaných databází."), QStringLiteral("N"));
+    const QCommandLineOption scanWorkersOption(QStringLiteral("scan-workers"),
+        QStringLiteral("Počet spojení současně čtoucích log jedné databáze (po VLF)."), QStringLiteral("N"));
+    const QCommandLineOption batchSizeOption(QStringLiteral("batch-size"),
+        QStringLiteral("Počet záznamů zapsaných v jedné transakci."), QStringLiteral("N"));
+    const QCommandLineOption pipelineOption(QStringLiteral("pipeline"),
+        QStringLiteral("Číst, seskupovat a zapisovat záznamy současně (log se nedrží v paměti)."));
+    const QCommandLineOption dumpStatisticsOption(QStringLiteral("dump-stats"),
+        QStringLiteral("Po každé aktualizaci uložit statistiky dotazů (JSON) do souboru."),
+        QStringLiteral("FILE"));
+    const QCommandLineOption nativeOdbcOption(QStringLiteral("native-odbc"),
+        QStringLiteral("Číst log přímo přes ODBC (bez QtSql), je-li k dispozici."));
+    const QCommandLineOption sharedTableOption(QStringLiteral("shared-table"),
+        QStringLiteral("Ukládat transakce všech databází do jedné sdílené tabulky."));
+    const QCommandLineOption migrateOption(QStringLiteral("migrate"),
+        QStringLiteral("Před aktualizací převést sledovací tabulky staršího uspořádání (může trvat dlouho)."));
+    const QCommandLineOption projectionOption(QStringLiteral("projection"),
+        QStringLiteral("Ukládané sloupce logu: metadata (výchozí), rows (+ obrazy řádků), full (+ celý záznam)."),
+        QStringLiteral("PROFILE"));
+
+    parser.addOptions({ harvestOption, onceOption, intervalOption, concurrencyOption, scanWorkersOption,
+                        batchSizeOption, pipelineOption, dumpStatisticsOption, nativeOdbcOption,
+                        projectionOption, sharedTableOption, migrateOption });
+
+    if (!parser.parse(QCoreApplication::arguments())) {
+
+        QTextStream(stderr) << parser.errorText() << QStringLiteral("\n");
+        return false;
+    }
+
+    if (parser.isSet(helpOption))
+        parser.showHelp(OK);
+
+    bool valueOk = true;
+    if (parser.isSet(intervalOption)) {
+
+        this->_interval = parser.value(intervalOption).toInt(&valueOk);
+        if (!valueOk || this->_interval < 1)
+            return false;
+    }
+    // without interval harvest runs only once
+    this->_once = parser.isSet(onceOption) || this->_interval == 0;
+
+    if (parser.isSet(concurrencyOption)) {
+
+        this->_concurrency = parser.value(concurrencyOption).toInt(&valueOk);
+        if (!valueOk || this->_concurrency < 1)
+            return false;
+    }
+
+    if (parser.isSet(scanWorkersOption)) {
+
+        this->_scanWorkers = parser.value(scanWorkersOption).toInt(&valueOk);
+        if (!valueOk || this->_scanWorkers < 1)
+            return false;
+    }
+
+    if (parser.isSet(batchSizeOption)) {
+
+        this->_batchSize = parser.value(batchSizeOption).toInt(&valueOk);
+        if (!valueOk || this->_batchSize < 1)
+            return false;
+    }
+
+    if (parser.isSet(projectionOption)) {
+
+        static const QMap<QString, Database::logProjection> projections =
+            { { QStringLiteral("metadata"), Database::METADATA_ONLY },
+              { QStringLiteral("rows"), Database::ROW_IMAGES },
+              { QStringLiteral("full"), Database::FULL_RECORD } };
+
+        const QString projection = parser.value(projectionOption).toLower();
+        if (!projections.contains(projection))
+            return false;
+        this->_projection = projections.value(projection);
+    }
+
+    if (parser.isSet(dumpStatisticsOption))
+        this->_statisticsFile = parser.value(dumpStatisticsOption);
+
+    this->_pipeline = parser.isSet(pipelineOption);
+    this->_sharedTable = parser.isSet(sharedTableOption);
+    this->_migrate = parser.isSet(migrateOption);
+    this->_nativeOdbc = parser.isSet(nativeOdbcOption);
+    if (this->_nativeOdbc && !OdbcBulkReader::isAvailable())
+        qWarning().noquote() << QStringLiteral("Přímé čtení přes ODBC není k dispozici, použije se QtSql.");
+
+    return true;
+}
+
+int HeadlessHarvest::exec() {
+
+    if (!this->parseArguments()) {
+
+        QTextStream(stderr) << QStringLiteral("Neplatné parametry příkazové řádky.\n");
+        return INVALID_ARGUMENTS;
+    }
+
+    this->_session = new Session;
+    if (!this->_session->systemDatabase()->connectionEstablished())
+        return NO_SYSTEM_DATABASE;
+
+    if (this->_sharedTable && !this->_session->useSharedTrackingTable()) {
+
+        QTextStream(stderr) << QStringLiteral("Nepodařilo se vytvořit sdílenou tabulku transakcí.\n");
+        return SHARED_TABLE_FAILED;
+    }
+
+    if (!this->migrateLogTables())
+        return MIGRATION_FAILED;
+
+    this->_session->setHarvestConcurrency(this->_concurrency);
+    for (auto it: this->_session->dbs()) {
+
+        it->setBatchSize(this->_batchSize);
+        it->setScanConcurrency(this->_scanWorkers);
+        it->setPipelinedHarvest(this->_pipeline);
+        it->setProjection(this->_projection);
+        if (this->_nativeOdbc)
+            it->setLogReader(Database::NATIVE_ODBC_READER);
+    }
+
+    if (this->_once)
+        return this->harvestCycle();
+
+    // periodic harvest (runs until process is terminated)
+    QTimer * const harvestTimer = new QTimer(this);
+    connect(harvestTimer, &QTimer::timeout, this,
+            [this]() -> void { this->_lastExitCode = this->harvestCycle(); });
+    harvestTimer->start(this->_interval * 1000);
+
+    this->_lastExitCode = this->harvestCycle();
+    QCoreApplication::exec();
+
+    return this->_lastExitCode;
+}
+
+// tables of older layout are harvested as they are unless migration was requested
+bool HeadlessHarvest::migrateLogTables() const {
+
+    QVector<Database *> databases;
+    if (!this->_session->logTablesToMigrate(databases)) {
+
+        QTextStream(stderr) << QStringLiteral("Nepodařilo se zjistit uspořádání sledovacích tabulek.\n");
+        return false;
+    }
+    if (databases.isEmpty())
+        return true;
+
+    if (!this->_migrate) {
+
+        qWarning().noquote() << QStringLiteral("Sledovací tabulky staršího uspořádání: ") +
+                                QString::number(databases.size()) +
+                                QStringLiteral(" (převod spustí parametr --migrate, může trvat dlouho).");
+        return true;
+    }
+
+    // one table (one transaction) at a time, progress is logged before each rebuild
+    for (int i = 0; i != databases.size(); ++i) {
+
+        qInfo().noquote() << QStringLiteral("Převod sledovací tabulky ") + QString::number(i + 1) +
+                             QStringLiteral("/") + QString::number(databases.size()) +
+                             QStringLiteral(": ") + databases.at(i)->dbName();
+        if (!databases.at(i)->migrateLogTableOfThisDB(this->_session->systemDatabase()->dbConnection())) {
+
+            QTextStream(stderr) << QStringLiteral("Nepodařilo se převést sledovací tabulku databáze ") +
+                                   databases.at(i)->dbName() + QStringLiteral(".\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+HeadlessHarvest::exitCode HeadlessHarvest::harvestCycle() {
+
+    QVector<HarvestResult> results;
+    const bool allHarvested = this->_session->loadRecordsFromAllLogs(results);
+
+    // one JSON object per line
+    QTextStream(stdout) << QJsonDocument(this->summary(results, allHarvested))
+                           .toJson(QJsonDocument::Compact) << QStringLiteral("\n");
+
+    // statistics are cumulative since start of process
+    qInfo().noquote() << QueryStatistics::summaryLine();
+    if (!this->_statisticsFile.isEmpty() && !this->dumpStatistics())
+        qWarning().noquote() << QStringLiteral("Statistiky dotazů nelze uložit do souboru ") +
+                                this->_statisticsFile;
+
+    return (allHarvested ? OK : HARVEST_FAILED);
+}
+
+QJsonObject HeadlessHarvest::summary(const QVector<HarvestResult> & results,
+                                     const bool allHarvested) const {
+
+    QJsonArray databases;
+    for (auto it: results) {
+
+        QJsonObject database;
+        database.insert(QStringLiteral("id"), it._ID.toString(QUuid::WithoutBraces));
+        database.insert(QStringLiteral("name"), it._dbName);
+        database.insert(QStringLiteral("success"), it._success);
+        database.insert(QStringLiteral("transactions"), it._transactions);
+        database.insert(QStringLiteral("rows"), it._ingestStatistics._rows);
+        database.insert(QStringLiteral("batches"), it._ingestStatistics._batches);
+        database.insert(QStringLiteral("duplicates"), it._ingestStatistics._duplicates);
+        database.insert(QStringLiteral("purged"), it._purgedRows);
+        database.insert(QStringLiteral("rowsPerSecond"), it._ingestStatistics.rowsPerSecond());
+        database.insert(QStringLiteral("elapsedMs"), it._elapsed);
+        if (!it._error.isEmpty())
+            database.insert(QStringLiteral("error"), it._error);
+        databases.append(database);
+    }
+
+    QJsonObject harvestSummary;
+    harvestSummary.insert(QStringLiteral("timestamp"),
+                          QDateTime::currentDateTime().toString(Qt::ISODate));
+    harvestSummary.insert(QStringLiteral("success"), allHarvested);
+    harvestSummary.insert(QStringLiteral("databases"), databases);
+    return harvestSummary;
+}
+
+bool HeadlessHarvest::dumpStatistics() const {
+
+    QFile statisticsFile(this->_statisticsFile);
+    if (!statisticsFile.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        return false;
+
+    QJsonObject statistics;
+    statistics.insert(QStringLiteral("timestamp"), QDateTime::currentDateTime().toString(Qt::ISODate));
+    statistics.insert(QStringLiteral("queries"), QueryStatistics::toJson());
+
+    return (statisticsFile.write(QJsonDocument(statistics).toJson(QJsonDocument::Indented)) != -1);
+}
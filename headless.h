@@ -0,0 +1,55 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef HEADLESS_H
+#define HEADLESS_H
+
+#include <QJsonObject>
+#include <QObject>
+#include <QVector>
+#include "harvest.h"
+#include "session.h"
+
+// command-line mode: DBLogger --harvest [--once] [--interval N] [--concurrency N] [--scan-workers N]
+// [--batch-size N] [--pipeline] [--dump-stats FILE] [--native-odbc] [--migrate] (connects to tracked databases and updates system
+// database only, no windows are shown; query statistics are logged after every cycle and optionally dumped to file as JSON;
+// tracking tables of older layout are rebuilt before harvest only with --migrate)
+class HeadlessHarvest: public QObject {
+
+    Q_OBJECT
+
+    public:
+        enum exitCode { OK = 0, HARVEST_FAILED = 1, NO_SYSTEM_DATABASE = 2, INVALID_ARGUMENTS = 3,
+                        MIGRATION_FAILED = 4, SHARED_TABLE_FAILED = 5 };
+
+        explicit HeadlessHarvest(QObject * = nullptr);
+        ~HeadlessHarvest();
+
+        static bool isRequested(int, char * []);
+        int exec();
+
+    private:
+        bool parseArguments();
+        bool migrateLogTables() const;
+        exitCode harvestCycle();
+        QJsonObject summary(const QVector<HarvestResult> &, const bool) const;
+        bool dumpStatistics() const;
+
+        Session * _session;
+        bool _once;
+        int _interval; // [s]
+        int _concurrency;
+        int _scanWorkers;
+        int _batchSize;
+        QString _statisticsFile;
+        bool _nativeOdbc;
+        bool _pipeline;
+        bool _sharedTable;
+        bool _migrate;
+        Database::logProjection _projection;
+        exitCode _lastExitCode;
+};
+
+#endif // HEADLESS_H
@@ -0,0 +1,186 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include "logfilter.h"
+
+bool LogFilter::typeFromName(const QString & name, filterType & type) {
+
+    static const QStringList typeNames { QStringLiteral("Operation"), QStringLiteral("Context"),
+                                         QStringLiteral("Object"), QStringLiteral("User") };
+
+    for (int typeIndex = 0; typeIndex < typeNames.size(); ++typeIndex) {
+
+        if (typeNames.at(typeIndex).compare(name.trimmed(), Qt::CaseInsensitive) == 0) {
+
+            type = static_cast<filterType>(typeIndex);
+            return true;
+        }
+    }
+    return false;
+}
+
+void LogFilter::add(const filterType type, const QString & value, const bool excluded) {
+
+    if (type == END_OF_FILTER_TYPES || value.trimmed().isEmpty())
+        return;
+
+    if (excluded)
+        this->_excluded[type] << value.trimmed();
+    else
+        this->_included[type] << value.trimmed();
+
+    if (type == OBJECT) {
+
+        this->_includedObjects = LogFilter::patternExpression(this->_included[OBJECT]);
+        this->_excludedObjects = LogFilter::patternExpression(this->_excluded[OBJECT]);
+    }
+    return;
+}
+
+void LogFilter::clear() {
+
+    for (int type = 0; type < END_OF_FILTER_TYPES; ++type) {
+
+        this->_included[type].clear();
+        this->_excluded[type].clear();
+    }
+    this->_includedObjects = QRegularExpression();
+    this->_excludedObjects = QRegularExpression();
+    return;
+}
+
+bool LogFilter::filtersRecords() const {
+
+    for (auto type: { OPERATION, CONTEXT, OBJECT })
+        if (!this->_included[type].isEmpty() || !this->_excluded[type].isEmpty())
+            return true;
+
+    return false;
+}
+
+CompiledLogFilter LogFilter::compile() const {
+
+    CompiledLogFilter compiledFilter;
+    if (!this->filtersRecords())
+        return compiledFilter;
+
+    QStringList conditions;
+    conditions << this->valueCondition(QStringLiteral("L.Operation"), OPERATION, compiledFilter)
+               << this->valueCondition(QStringLiteral("L.Context"), CONTEXT, compiledFilter)
+               << this->objectCondition(compiledFilter);
+    conditions.removeAll(QString());
+    if (conditions.isEmpty())
+        conditions << QStringLiteral("1 = 1");
+
+    compiledFilter._condition = QStringLiteral("(L.Operation IN ('LOP_BEGIN_XACT', 'LOP_COMMIT_XACT', "
+        "'LOP_ABORT_XACT') OR (") + conditions.join(QStringLiteral(" AND ")) + QStringLiteral("))");
+    return compiledFilter;
+}
+
+bool LogFilter::accepts(const QString & userName, const int noOfDataRecords) const {
+
+    if (this->filtersRecords() && noOfDataRecords == 0)
+        return false;
+
+    const auto matches = [&userName](const QStringList & users) -> bool
+        { return users.contains(userName, Qt::CaseInsensitive); };
+
+    return ((this->_included[USER].isEmpty() || matches(this->_included[USER])) &&
+            !matches(this->_excluded[USER]));
+}
+
+bool LogFilter::acceptsObject(const QString & objectName) const {
+
+    if (objectName.isEmpty())
+        return true;
+
+    return ((this->_included[OBJECT].isEmpty() || this->_includedObjects.match(objectName).hasMatch()) &&
+            (this->_excluded[OBJECT].isEmpty() || !this->_excludedObjects.match(objectName).hasMatch()));
+}
+
+// patterns (% = any string, _ = any character) as one expression matching whole name
+QRegularExpression LogFilter::patternExpression(const QStringList & patterns) {
+
+    QStringList alternatives;
+    for (auto it: patterns)
+        alternatives << QRegularExpression::escape(it)
+                        .replace(QStringLiteral("\\%"), QStringLiteral(".*"))
+                        .replace(QStringLiteral("_"), QStringLiteral("."));
+    return QRegularExpression(QStringLiteral("^(") + alternatives.join(QChar('|')) + QStringLiteral(")$"),
+                              QRegularExpression::CaseInsensitiveOption);
+}
+
+// values are bound as parameters (:filter0, :filter1, ...)
+QStringList LogFilter::parameterList(const QStringList & values, CompiledLogFilter & compiledFilter) {
+
+    QStringList placeholders;
+    for (auto it: values) {
+
+        const QString placeholder =
+            QStringLiteral(":filter") + QString::number(compiledFilter._parameters.size());
+        compiledFilter._parameters.push_back(qMakePair(placeholder, it));
+        placeholders << placeholder;
+    }
+    return placeholders;
+}
+
+QString LogFilter::valueCondition(const QString & column, const filterType type,
+                                  CompiledLogFilter & compiledFilter) const {
+
+    QStringList conditions;
+    if (!this->_included[type].isEmpty())
+        conditions << column + QStringLiteral(" IN (") +
+                      parameterList(this->_included[type], compiledFilter).join(QStringLiteral(", ")) +
+                      QStringLiteral(")");
+    if (!this->_excluded[type].isEmpty())
+        conditions << column + QStringLiteral(" NOT IN (") +
+                      parameterList(this->_excluded[type], compiledFilter).join(QStringLiteral(", ")) +
+                      QStringLiteral(")");
+
+    return conditions.join(QStringLiteral(" AND "));
+}
+
+// patterns are matched by server (LIKE over catalog of database whose log is read, the same names
+// as in ObjectNameCache), so statement does not depend on number of units. Units missing in
+// catalog (dropped, or log backup of other state) and DDL records always pass (see acceptsObject)
+QString LogFilter::objectCondition(CompiledLogFilter & compiledFilter) const {
+
+    static const QString unitOfRecord = QStringLiteral(
+        "SELECT 1 FROM sys.system_internals_allocation_units AS AU "
+        "WHERE AU.allocation_unit_id = L.AllocUnitId");
+    static const QString namedUnitOfRecord = QStringLiteral(
+        "SELECT 1 FROM sys.system_internals_allocation_units AS AU "
+        "INNER JOIN sys.partitions AS P ON P.partition_id = AU.container_id "
+        "INNER JOIN sys.objects AS O ON P.object_id = O.object_id "
+        "INNER JOIN sys.schemas AS S ON O.schema_id = S.schema_id "
+        "WHERE AU.allocation_unit_id = L.AllocUnitId AND (");
+
+    // name of unit matches one of patterns
+    const auto namedUnit = [&compiledFilter](const QStringList & patterns) -> QString {
+
+        QStringList alternatives;
+        for (auto it: parameterList(patterns, compiledFilter))
+            alternatives << QStringLiteral("S.name + N'.' + O.name LIKE ") + it;
+        return namedUnitOfRecord + alternatives.join(QStringLiteral(" OR ")) + QStringLiteral(")");
+    };
+
+    QStringList ddlOperations;
+    for (auto it: ObjectNameCache::ddlOperations())
+        ddlOperations << QStringLiteral("'") + it + QStringLiteral("'");
+    const QString unfiltered = QStringLiteral("L.Operation IN (") + ddlOperations.join(QStringLiteral(", ")) +
+                               QStringLiteral(")");
+
+    QStringList conditions;
+    if (!this->_included[OBJECT].isEmpty())
+        conditions << QStringLiteral("(") + unfiltered +
+                      QStringLiteral(" OR (L.AllocUnitId IS NOT NULL AND NOT EXISTS (") + unitOfRecord +
+                      QStringLiteral(")) OR EXISTS (") + namedUnit(this->_included[OBJECT]) +
+                      QStringLiteral("))");
+    if (!this->_excluded[OBJECT].isEmpty())
+        conditions << QStringLiteral("(") + unfiltered + QStringLiteral(" OR NOT EXISTS (") +
+                      namedUnit(this->_excluded[OBJECT]) + QStringLiteral("))");
+
+    return conditions.join(QStringLiteral(" AND "));
+}
@@ -0,0 +1,67 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef LOGFILTER_H
+#define LOGFILTER_H
+
+#include <QPair>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "objectnamecache.h"
+
+// filter compiled for one log query: condition replaces :logFilter placeholder of query,
+// values are bound to named parameters used in it
+struct CompiledLogFilter {
+
+    QString _condition = QStringLiteral("1 = 1");
+    QVector<QPair<QString, QString>> _parameters;
+};
+
+// which log records of database are harvested (table LogFilters in system database); every type
+// has list of included (empty = all) and excluded values. Operations, contexts and objects
+// (LIKE patterns on schema.object, matched against catalog joined to AllocUnitId) are evaluated
+// by server, records of transaction control are always read (transactions are assembled from them).
+// Units missing in catalog and DDL records are passed by server, their names are matched
+// client-side once they are resolved. Users are known from first record
+// of transaction only => evaluated for assembled transactions
+class LogFilter {
+
+    public:
+        LogFilter() {}
+        ~LogFilter() {}
+
+        enum filterType { OPERATION, CONTEXT, OBJECT, USER, END_OF_FILTER_TYPES };
+
+        static bool typeFromName(const QString &, filterType &);
+
+        void add(const filterType, const QString &, const bool);
+        void clear();
+        inline bool isEmpty() const { return (!filtersRecords() && !filtersUsers()); }
+        bool filtersRecords() const;
+        inline bool filtersUsers() const
+            { return !(_included[USER].isEmpty() && _excluded[USER].isEmpty()); }
+
+        CompiledLogFilter compile() const;
+        // transaction without records passing server-side filter is not tracked
+        bool accepts(const QString &, const int) const;
+        // record with resolved object name (empty name = no object, it is always accepted)
+        bool acceptsObject(const QString &) const;
+
+    private:
+        static QRegularExpression patternExpression(const QStringList &);
+        static QStringList parameterList(const QStringList &, CompiledLogFilter &);
+
+        QString valueCondition(const QString &, const filterType, CompiledLogFilter &) const;
+        QString objectCondition(CompiledLogFilter &) const;
+
+        QStringList _included[END_OF_FILTER_TYPES];
+        QStringList _excluded[END_OF_FILTER_TYPES];
+        QRegularExpression _includedObjects;
+        QRegularExpression _excludedObjects;
+};
+
+#endif // LOGFILTER_H
@@ -0,0 +1,159 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include "logstore.h"
+
+StringPool::StringPool() {
+
+    this->clear();
+}
+
+quint32 StringPool::intern(const QString & value) {
+
+    if (value.isEmpty())
+        return 0;
+
+    auto existingString = this->_IDs.constFind(value);
+    if (existingString != this->_IDs.cend())
+        return existingString.value();
+
+    const quint32 newID = quint32(this->_strings.size());
+    this->_strings.push_back(value);
+    this->_IDs.insert(value, newID);
+    return newID;
+}
+
+void StringPool::clear() {
+
+    this->_strings.clear();
+    this->_IDs.clear();
+    this->_strings.push_back(QString());
+    return;
+}
+
+qint64 StringPool::memoryUsage() const {
+
+    qint64 usage = 0;
+    for (const QString & it: this->_strings)
+        usage += 2 * sizeof(QString) + it.capacity() * sizeof(QChar); // data is shared with hash key
+
+    return usage;
+}
+
+void LogStore::append(const QString & objectName, const QString & operation,
+                      const QString & transactionName, const QString & transactionID,
+                      const QDateTime & beginTime, const QDateTime & endTime,
+                      const QString & userName, const LSN & currentLSN) {
+
+    const qint32 record = this->_lsns.size();
+
+    this->_objectNames.push_back(this->_strings.intern(objectName));
+    this->_operations.push_back(this->_strings.intern(operation));
+    this->_transactionNames.push_back(this->_strings.intern(transactionName));
+    this->_userNames.push_back(this->_strings.intern(userName));
+    this->_beginTimes.push_back(fromDateTime(beginTime));
+    this->_endTimes.push_back(fromDateTime(endTime));
+    this->_lsns.push_back(currentLSN);
+    this->_nextRecords.push_back(-1);
+
+    // find or open transaction and link record to its chain
+    auto transactionIndex = this->_transactionIndex.constFind(transactionID);
+    if (transactionIndex == this->_transactionIndex.cend()) {
+
+        LogTransaction newTransaction;
+        newTransaction._transactionID = transactionID;
+        newTransaction._firstRecord = record;
+        transactionIndex = this->_transactionIndex.insert(transactionID, this->_transactions.size());
+        this->_transactions.push_back(newTransaction);
+    }
+    else
+        this->_nextRecords[this->_transactions.at(transactionIndex.value())._lastRecord] = record;
+
+    this->_recordTransactions.push_back(transactionIndex.value());
+
+    LogTransaction & currentTransaction = this->_transactions[transactionIndex.value()];
+    currentTransaction._lastRecord = record;
+    ++(currentTransaction._noOfRecords);
+    currentTransaction._range.extend(currentLSN);
+    if (currentTransaction._objectRecord == -1 && !objectName.isEmpty())
+        currentTransaction._objectRecord = record;
+
+    return;
+}
+
+void LogStore::setObjectName(const int record, const QString & transactionID,
+                             const QString & objectName) {
+
+    this->_objectNames[record] = this->_strings.intern(objectName);
+
+    const auto transactionIndex = this->_transactionIndex.constFind(transactionID);
+    if (objectName.isEmpty() || transactionIndex == this->_transactionIndex.cend())
+        return;
+
+    LogTransaction & currentTransaction = this->_transactions[transactionIndex.value()];
+    if (currentTransaction._objectRecord == -1 || record < currentTransaction._objectRecord)
+        currentTransaction._objectRecord = record;
+
+    return;
+}
+
+void LogStore::clear() {
+
+    this->_strings.clear();
+    this->_objectNames.clear();
+    this->_operations.clear();
+    this->_transactionNames.clear();
+    this->_userNames.clear();
+    this->_beginTimes.clear();
+    this->_endTimes.clear();
+    this->_lsns.clear();
+    this->_nextRecords.clear();
+    this->_recordTransactions.clear();
+    this->_transactions.clear();
+    this->_transactionIndex.clear();
+    return;
+}
+
+qint64 LogStore::memoryUsage() const {
+
+    const qint64 perRecord = 4 * sizeof(quint32) + 2 * sizeof(qint64) + sizeof(LSN) + 2 * sizeof(qint32);
+    qint64 perTransaction = 0;
+    for (const LogTransaction & it: this->_transactions)
+        perTransaction += sizeof(LogTransaction) + sizeof(QString) + sizeof(qint32) +
+                          it._transactionID.capacity() * sizeof(QChar); // data is shared with hash key
+
+    return (this->_lsns.capacity() * perRecord + perTransaction + this->_strings.memoryUsage());
+}
+
+void LogRecordBuffer::append(const qint64 allocationUnitID, const QString & operation,
+                             const QString & transactionName, const QString & transactionID,
+                             const QDateTime & beginTime, const QDateTime & endTime,
+                             const QString & userName, const LSN & currentLSN) {
+
+    this->_allocationUnitIDs.push_back(allocationUnitID);
+    this->_operations.push_back(this->_strings.intern(operation));
+    this->_transactionNames.push_back(this->_strings.intern(transactionName));
+    this->_transactionIDs.push_back(this->_strings.intern(transactionID));
+    this->_userNames.push_back(this->_strings.intern(userName));
+    this->_beginTimes.push_back(LogStore::fromDateTime(beginTime));
+    this->_endTimes.push_back(LogStore::fromDateTime(endTime));
+    this->_lsns.push_back(currentLSN);
+    return;
+}
+
+// memory is released (buffer is not reused)
+void LogRecordBuffer::clear() {
+
+    this->_strings = StringPool();
+    this->_allocationUnitIDs = QVector<qint64>();
+    this->_operations = QVector<quint32>();
+    this->_transactionNames = QVector<quint32>();
+    this->_transactionIDs = QVector<quint32>();
+    this->_userNames = QVector<quint32>();
+    this->_beginTimes = QVector<qint64>();
+    this->_endTimes = QVector<qint64>();
+    this->_lsns = QVector<LSN>();
+    return;
+}
@@ -0,0 +1,138 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef LOGSTORE_H
+#define LOGSTORE_H
+
+#include <limits>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QVector>
+#include "lsn.h"
+
+// every distinct string is stored once and referenced by its ID (0 = empty string)
+class StringPool {
+
+    public:
+        StringPool();
+        ~StringPool() {}
+
+        quint32 intern(const QString &);
+        inline const QString & at(const quint32 ID) const { return _strings.at(ID); }
+        inline int size() const { return _strings.size(); }
+        void clear();
+        qint64 memoryUsage() const;
+
+    private:
+        QVector<QString> _strings;
+        QHash<QString, quint32> _IDs;
+};
+
+// transaction = chain of its records (in order of log) and values needed for tracking table,
+// which are maintained while records are appended
+struct LogTransaction {
+
+    QString _transactionID;
+    qint32 _firstRecord = -1;
+    qint32 _lastRecord = -1;
+    qint32 _objectRecord = -1; // first record referring to an object
+    qint32 _noOfRecords = 0;
+    LSNRange _range;
+};
+
+// harvested log records as struct of arrays: low-cardinality columns are interned,
+// times are kept as ms since epoch, transactions are indexed by hash of transaction ID
+class LogStore {
+
+    public:
+        LogStore() {}
+        ~LogStore() {}
+
+        void append(const QString &, const QString &, const QString &, const QString &,
+                    const QDateTime &, const QDateTime &, const QString &, const LSN &);
+        // name resolved only after record was appended (record has to belong to given transaction)
+        void setObjectName(const int, const QString &, const QString &);
+        void clear();
+        qint64 memoryUsage() const; // [B], approximate
+
+        inline int noOfRecords() const { return _lsns.size(); }
+        inline int noOfTransactions() const { return _transactions.size(); }
+        inline const LogTransaction & transaction(const int index) const { return _transactions.at(index); }
+        // records of transaction: firstRecord .. nextRecord() == -1
+        inline int nextRecord(const int record) const { return _nextRecords.at(record); }
+        inline const QString & transactionID(const int record) const
+            { return _transactions.at(_recordTransactions.at(record))._transactionID; }
+
+        inline const QString & objectName(const int record) const { return _strings.at(_objectNames.at(record)); }
+        inline const QString & operation(const int record) const { return _strings.at(_operations.at(record)); }
+        inline const QString & transactionName(const int record) const
+            { return _strings.at(_transactionNames.at(record)); }
+        inline const QString & userName(const int record) const { return _strings.at(_userNames.at(record)); }
+        inline QDateTime beginTime(const int record) const { return toDateTime(_beginTimes.at(record)); }
+        inline QDateTime endTime(const int record) const { return toDateTime(_endTimes.at(record)); }
+        inline const LSN & currentLSN(const int record) const { return _lsns.at(record); }
+
+    private:
+        friend class LogRecordBuffer;
+
+        static const qint64 nullTime = std::numeric_limits<qint64>::min();
+        static inline qint64 fromDateTime(const QDateTime & time)
+            { return (time.isValid() ? time.toMSecsSinceEpoch() : nullTime); }
+        static inline QDateTime toDateTime(const qint64 time)
+            { return ((time == nullTime) ? QDateTime() : QDateTime::fromMSecsSinceEpoch(time)); }
+
+        StringPool _strings;
+        QVector<quint32> _objectNames;
+        QVector<quint32> _operations;
+        QVector<quint32> _transactionNames;
+        QVector<quint32> _userNames;
+        QVector<qint64> _beginTimes;
+        QVector<qint64> _endTimes;
+        QVector<LSN> _lsns;
+        QVector<qint32> _nextRecords;
+        QVector<qint32> _recordTransactions;
+
+        QVector<LogTransaction> _transactions;
+        QHash<QString, qint32> _transactionIndex;
+};
+
+// decoded log records kept in LSN order without grouping (one chunk of parallel scan),
+// columns are stored the same way as in LogStore
+class LogRecordBuffer {
+
+    public:
+        LogRecordBuffer() {}
+        ~LogRecordBuffer() {}
+
+        void append(const qint64, const QString &, const QString &, const QString &,
+                    const QDateTime &, const QDateTime &, const QString &, const LSN &);
+        void clear();
+
+        inline int noOfRecords() const { return _lsns.size(); }
+        inline qint64 allocationUnitID(const int record) const { return _allocationUnitIDs.at(record); }
+        inline const QString & operation(const int record) const { return _strings.at(_operations.at(record)); }
+        inline const QString & transactionName(const int record) const
+            { return _strings.at(_transactionNames.at(record)); }
+        inline const QString & transactionID(const int record) const
+            { return _strings.at(_transactionIDs.at(record)); }
+        inline const QString & userName(const int record) const { return _strings.at(_userNames.at(record)); }
+        inline QDateTime beginTime(const int record) const { return LogStore::toDateTime(_beginTimes.at(record)); }
+        inline QDateTime endTime(const int record) const { return LogStore::toDateTime(_endTimes.at(record)); }
+        inline const LSN & currentLSN(const int record) const { return _lsns.at(record); }
+
+    private:
+        StringPool _strings;
+        QVector<qint64> _allocationUnitIDs;
+        QVector<quint32> _operations;
+        QVector<quint32> _transactionNames;
+        QVector<quint32> _transactionIDs;
+        QVector<quint32> _userNames;
+        QVector<qint64> _beginTimes;
+        QVector<qint64> _endTimes;
+        QVector<LSN> _lsns;
+};
+
+#endif // LOGSTORE_H
@@ -0,0 +1,164 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include <QSqlDatabase>
+#include "constants.h"
+#include "logtablemodel.h"
+#include "query.h"
+
+// columns of tracking table shown in view (LSNs are last two)
+static const QStringList logTableColumns { QStringLiteral("ObjectName"), QStringLiteral("Operation"),
+    QStringLiteral("TransactionID"), QStringLiteral("BeginTime"), QStringLiteral("EndTime"),
+    QStringLiteral("UserName"), QStringLiteral("BeginLSN"), QStringLiteral("EndLSN") };
+
+LogTableModel::LogTableModel(QObject * parent):
+    QAbstractTableModel(parent), _rowCount(0), _allRowsFetched(true),
+    _pages(sql::logTableCachedPages) {}
+
+// switching table takes constant time, first page is fetched when view asks for it
+void LogTableModel::setTable(const QString & connectionName, const QString & tableName,
+                             const QString & trackedRows) {
+
+    this->beginResetModel();
+    this->_connectionName = connectionName;
+    this->_tableName = tableName;
+    this->_trackedRows = trackedRows;
+    this->_rowCount = 0;
+    this->_allRowsFetched = tableName.isEmpty();
+    this->_pageKeys.clear();
+    this->_pages.clear();
+    this->endResetModel();
+    return;
+}
+
+void LogTableModel::clear() {
+
+    this->setTable(QString(), QString(), QString());
+    return;
+}
+
+int LogTableModel::rowCount(const QModelIndex & parent) const {
+
+    return (parent.isValid() ? 0 : this->_rowCount);
+}
+
+int LogTableModel::columnCount(const QModelIndex & parent) const {
+
+    return (parent.isValid() ? 0 : logTableColumns.size());
+}
+
+QVariant LogTableModel::data(const QModelIndex & index, int role) const {
+
+    if (!index.isValid() || role != Qt::DisplayRole || index.row() >= this->_rowCount)
+        return QVariant();
+
+    const LogTablePage * const rows = this->page(index.row() / sql::logTablePageSize);
+    const int rowInPage = index.row() % sql::logTablePageSize;
+    if (rows == nullptr || rowInPage >= rows->size())
+        return QVariant();
+
+    const QVariant & value = rows->at(rowInPage).at(index.column());
+    if (index.column() >= logTableColumns.size() - 2)
+        return LSN::fromVariant(value).toString();
+
+    return value;
+}
+
+QVariant LogTableModel::headerData(int section, Qt::Orientation orientation, int role) const {
+
+    if (role != Qt::DisplayRole)
+        return QVariant();
+
+    if (orientation == Qt::Horizontal)
+        return ((section < logTableColumns.size()) ? logTableColumns.at(section) : QVariant());
+
+    return (section + 1);
+}
+
+bool LogTableModel::canFetchMore(const QModelIndex & parent) const {
+
+    return (!parent.isValid() && !this->_allRowsFetched);
+}
+
+void LogTableModel::fetchMore(const QModelIndex & parent) {
+
+    if (parent.isValid() || this->_allRowsFetched)
+        return;
+
+    const int pageNo = this->_pageKeys.size();
+    LogTablePage * const newPage = new LogTablePage;
+
+    if (!this->loadPage(pageNo, *newPage) || newPage->isEmpty()) {
+
+        this->_allRowsFetched = true;
+        delete newPage;
+        return;
+    }
+
+    this->_allRowsFetched = (newPage->size() < sql::logTablePageSize);
+    this->_pageKeys.push_back(LSN::fromVariant(newPage->last().last()));
+
+    this->beginInsertRows(QModelIndex(), this->_rowCount, this->_rowCount + newPage->size() - 1);
+    this->_rowCount += newPage->size();
+    this->_pages.insert(pageNo, newPage);
+    this->endInsertRows();
+    return;
+}
+
+// cached page or page re-read from tracking table (keyset of every fetched page is known)
+const LogTablePage * LogTableModel::page(const int pageNo) const {
+
+    const LogTablePage * const cachedPage = this->_pages.object(pageNo);
+    if (cachedPage != nullptr)
+        return cachedPage;
+
+    LogTablePage * const reloadedPage = new LogTablePage;
+    if (!this->loadPage(pageNo, *reloadedPage)) {
+
+        delete reloadedPage;
+        return nullptr;
+    }
+
+    this->_pages.insert(pageNo, reloadedPage);
+    return reloadedPage;
+}
+
+bool LogTableModel::loadPage(const int pageNo, LogTablePage & rows) const {
+
+    const QString resourceForQuery = (pageNo == 0)
+        ? QStringLiteral(":/query/sql/retrieve_first_log_table_page.sql")
+        : QStringLiteral(":/query/sql/retrieve_next_log_table_page.sql");
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->_tableName),
+        qMakePair<QString, QString>(QStringLiteral(":pageSize"), QString::number(sql::logTablePageSize)) };
+
+    const QSqlDatabase connection = QSqlDatabase::database(this->_connectionName);
+    Query * const queryToExecute = new Query(&connection, customBindings);
+    queryToExecute->setForwardOnly(true);
+    queryToExecute->setClause(QStringLiteral(":trackedRows"), this->_trackedRows);
+    bool pageLoaded = false;
+
+    if (queryToExecute->prepareQuery(resourceForQuery)) {
+
+        if (pageNo > 0)
+            queryToExecute->setBinding(0, this->_pageKeys.at(pageNo - 1).toBinary());
+
+        rows.reserve(sql::logTablePageSize);
+        const int noOfColumns = logTableColumns.size();
+        pageLoaded = queryToExecute->processSelectQuery([&rows, noOfColumns](const QueryRow & row) -> bool {
+
+            QVector<QVariant> values;
+            values.reserve(noOfColumns);
+            for (int column = 0; column < noOfColumns; ++column)
+                values.push_back(row.at(column));
+            rows.push_back(values);
+            return true;
+        });
+    }
+    delete queryToExecute;
+    return pageLoaded;
+}
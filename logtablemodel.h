@@ -0,0 +1,55 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef LOGTABLEMODEL_H
+#define LOGTABLEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QCache>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+#include "lsn.h"
+
+typedef QVector<QVector<QVariant>> LogTablePage;
+
+// read-only view of tracking table (newest transactions first); rows are fetched lazily
+// page by page using EndLSN as keyset (no OFFSET), pages are kept in LRU cache
+// and re-read by their keyset when evicted page is needed again
+class LogTableModel: public QAbstractTableModel {
+
+    Q_OBJECT
+
+    public:
+        explicit LogTableModel(QObject * = nullptr);
+        ~LogTableModel() {}
+
+        void setTable(const QString &, const QString &, const QString &);
+        void clear();
+
+        int rowCount(const QModelIndex & = QModelIndex()) const override;
+        int columnCount(const QModelIndex & = QModelIndex()) const override;
+        QVariant data(const QModelIndex &, int = Qt::DisplayRole) const override;
+        QVariant headerData(int, Qt::Orientation, int = Qt::DisplayRole) const override;
+
+        bool canFetchMore(const QModelIndex &) const override;
+        void fetchMore(const QModelIndex &) override;
+
+    private:
+        const LogTablePage * page(const int) const;
+        bool loadPage(const int, LogTablePage &) const;
+
+        QString _connectionName;
+        QString _tableName;
+        QString _trackedRows; // condition selecting rows of database (table can be shared)
+        int _rowCount;
+        bool _allRowsFetched;
+        // EndLSN of last row of every fetched page (= keyset of following page)
+        QVector<LSN> _pageKeys;
+        mutable QCache<int, LogTablePage> _pages;
+};
+
+#endif // LOGTABLEMODEL_H
@@ -0,0 +1,113 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include <QStringList>
+#include <QtEndian>
+#include "lsn.h"
+
+LSN::LSN(const quint32 vlfSequence, const quint32 blockOffset, const quint16 slot) {
+
+    qToBigEndian(vlfSequence, _bytes);
+    qToBigEndian(blockOffset, _bytes + 4);
+    qToBigEndian(slot, _bytes + 8);
+}
+
+LSN LSN::fromString(const QString & lsn, bool * ok) {
+
+    const QStringList parts = lsn.trimmed().split(QChar(':'));
+    bool converted = (parts.size() == 3);
+
+    quint32 vlfSequence = 0, blockOffset = 0;
+    quint16 slot = 0;
+
+    if (converted) {
+
+        bool vlfOk = false, blockOk = false, slotOk = false;
+        QString vlfPart = parts.at(0);
+        if (vlfPart.startsWith(QStringLiteral("0x"), Qt::CaseInsensitive))
+            vlfPart.remove(0, 2);
+
+        vlfSequence = vlfPart.toUInt(&vlfOk, 16);
+        blockOffset = parts.at(1).toUInt(&blockOk, 16);
+        slot = parts.at(2).toUShort(&slotOk, 16);
+        converted = vlfOk && blockOk && slotOk;
+    }
+
+    if (ok != nullptr)
+        *ok = converted;
+
+    return (converted ? LSN(vlfSequence, blockOffset, slot) : LSN());
+}
+
+LSN LSN::fromNumeric(const QString & lsn, bool * ok) {
+
+    const QString digits = lsn.trimmed();
+    bool converted = (digits.size() > 15 && digits.size() <= 25);
+
+    quint32 vlfSequence = 0, blockOffset = 0;
+    quint16 slot = 0;
+
+    if (converted) {
+
+        bool vlfOk = false, blockOk = false, slotOk = false;
+        vlfSequence = digits.left(digits.size() - 15).toUInt(&vlfOk);
+        blockOffset = digits.mid(digits.size() - 15, 10).toUInt(&blockOk);
+        slot = digits.right(5).toUShort(&slotOk);
+        converted = vlfOk && blockOk && slotOk;
+    }
+
+    if (ok != nullptr)
+        *ok = converted;
+
+    return (converted ? LSN(vlfSequence, blockOffset, slot) : LSN());
+}
+
+LSN LSN::fromBinary(const QByteArray & lsn) {
+
+    LSN result;
+    if (lsn.size() == size)
+        std::memcpy(result._bytes, lsn.constData(), size);
+
+    return result;
+}
+
+// binary(10) column or text as returned by fn_dblog
+LSN LSN::fromVariant(const QVariant & lsn) {
+
+    if (lsn.isNull())
+        return LSN();
+
+    if (lsn.type() == QVariant::ByteArray)
+        return LSN::fromBinary(lsn.toByteArray());
+
+    return LSN::fromString(lsn.toString());
+}
+
+quint32 LSN::vlfSequence() const { return qFromBigEndian<quint32>(_bytes); }
+
+quint32 LSN::blockOffset() const { return qFromBigEndian<quint32>(_bytes + 4); }
+
+quint16 LSN::slot() const { return qFromBigEndian<quint16>(_bytes + 8); }
+
+QString LSN::toString() const {
+
+    return (QStringLiteral("%1:%2:%3")
+            .arg(this->vlfSequence(), 8, 16, QChar('0'))
+            .arg(this->blockOffset(), 8, 16, QChar('0'))
+            .arg(this->slot(), 4, 16, QChar('0')));
+}
+
+// fn_dblog accepts hexadecimal LSN only with 0x prefix
+QString LSN::toFnDblogParameter() const {
+
+    return (QStringLiteral("0x") + this->toString());
+}
+
+qint64 LSN::distanceTo(const LSN & to) const {
+
+    const qint64 fromPosition = (qint64(this->vlfSequence()) << 32) | this->blockOffset();
+    const qint64 toPosition = (qint64(to.vlfSequence()) << 32) | to.blockOffset();
+    return (toPosition - fromPosition);
+}
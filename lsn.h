@@ -0,0 +1,91 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef LSN_H
+#define LSN_H
+
+#include <cstring>
+#include <QByteArray>
+#include <QHash>
+#include <QMetaType>
+#include <QString>
+#include <QVariant>
+
+// log sequence number (VLF sequence : log block offset : slot), stored in 10 bytes big-endian,
+// i.e. byte order equals LSN order (same as binary(10) column in SQL Server)
+class LSN {
+
+    public:
+        LSN() { std::memset(_bytes, 0, size); }
+        LSN(const quint32, const quint32, const quint16);
+        ~LSN() {}
+
+        static const int size = 10;
+
+        // "0000002a:00000120:0001" (as returned by fn_dblog in [Current LSN])
+        static LSN fromString(const QString &, bool * = nullptr);
+        // decimal form used by msdb (VLF sequence * 10^15 + block offset * 10^5 + slot)
+        static LSN fromNumeric(const QString &, bool * = nullptr);
+        static LSN fromBinary(const QByteArray &);
+        static LSN fromVariant(const QVariant &);
+
+        QString toString() const;
+        QString toFnDblogParameter() const;
+        QByteArray toBinary() const
+            { return QByteArray(reinterpret_cast<const char *>(_bytes), size); }
+
+        quint32 vlfSequence() const;
+        quint32 blockOffset() const;
+        quint16 slot() const;
+        inline bool isNull() const { return (*this == LSN()); }
+
+        // distance in log blocks (VLF sequence is the high part), slot is ignored
+        qint64 distanceTo(const LSN &) const;
+
+        static const LSN & min(const LSN & lhs, const LSN & rhs) { return (rhs < lhs) ? rhs : lhs; }
+        static const LSN & max(const LSN & lhs, const LSN & rhs) { return (lhs < rhs) ? rhs : lhs; }
+
+        inline bool operator==(const LSN & rhs) const
+            { return (std::memcmp(_bytes, rhs._bytes, size) == 0); }
+        inline bool operator!=(const LSN & rhs) const { return !(*this == rhs); }
+        inline bool operator<(const LSN & rhs) const
+            { return (std::memcmp(_bytes, rhs._bytes, size) < 0); }
+        inline bool operator>(const LSN & rhs) const { return (rhs < *this); }
+        inline bool operator<=(const LSN & rhs) const { return !(rhs < *this); }
+        inline bool operator>=(const LSN & rhs) const { return !(*this < rhs); }
+
+        friend uint qHash(const LSN & lsn, uint seed = 0)
+            { return qHashBits(lsn._bytes, size, seed); }
+
+    private:
+        quint8 _bytes[size];
+};
+
+Q_DECLARE_METATYPE(LSN)
+
+// closed range of LSNs
+class LSNRange {
+
+    public:
+        LSNRange() {}
+        LSNRange(const LSN & from, const LSN & to): _from(LSN::min(from, to)), _to(LSN::max(from, to)) {}
+        ~LSNRange() {}
+
+        inline LSN from() const { return _from; }
+        inline LSN to() const { return _to; }
+        inline bool isNull() const { return (_from.isNull() && _to.isNull()); }
+        inline bool contains(const LSN & lsn) const { return (_from <= lsn && lsn <= _to); }
+        inline bool overlaps(const LSNRange & rhs) const { return (_from <= rhs._to && rhs._from <= _to); }
+        inline void extend(const LSN & lsn)
+            { if (isNull()) _from = _to = lsn;
+              else { _from = LSN::min(_from, lsn); _to = LSN::max(_to, lsn); } return; }
+        inline qint64 length() const { return _from.distanceTo(_to); }
+
+    private:
+        LSN _from;
+        LSN _to;
+};
+
+#endif // LSN_H
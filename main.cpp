@@ -18,6 +18,9 @@
  */
 
 #include <QApplication>
+#include <QCoreApplication>
+#include "benchmark.h"
+#include "headless.h"
 #include "mainwindow.h"
 #include "session.h"
 
@@ -25,6 +28,22 @@ int main(int argc, char * argv[])
 {
     Q_INIT_RESOURCE(resource);
 
+    // command-line mode (no display needed => no QApplication)
+    if (HeadlessHarvest::isRequested(argc, argv)) {
+
+        QCoreApplication app(argc, argv);
+        HeadlessHarvest harvest;
+        return harvest.exec();
+    }
+
+    // throughput measurement on synthetic log (no SQL Server needed)
+    if (LogBenchmark::isRequested(argc, argv)) {
+
+        QCoreApplication app(argc, argv);
+        LogBenchmark benchmark;
+        return benchmark.exec();
+    }
+
     QApplication app(argc, argv);
 
     int exitValue = 0;
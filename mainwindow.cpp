@@ -5,15 +5,49 @@
 
 #include <QApplication>
 #include <QDialog>
+#include <QFontDatabase>
 #include "mainwindow.h"
+#include "querystatistics.h"
 #include "shared.h"
+#include "statementcache.h"
 #include "ui/ui_mainwindow.h"
 
 MainWindow::MainWindow(Session * session, QWidget * parent):
-    QDialog(parent), ui(new Ui_MainWindow), _currentSession(session) {
+    QDialog(parent), ui(new Ui_MainWindow), _currentSession(session),
+    _progressBar(new QProgressBar(this)), _cancelButton(new QPushButton(QStringLiteral("Přerušit"), this)),
+    _statisticsButton(new QPushButton(QStringLiteral("Statistiky dotazů"), this)),
+    _statisticsPanel(new QPlainTextEdit(this)), _imagesPanel(new QPlainTextEdit(this)),
+    _logTableModel(new LogTableModel(this)),
+    _busyDatabaseID(QUuid()) {
 
     ui->setupUi(this);
 
+    // one view and model for all databases (only table of model is switched)
+    ui->logTableView->setModel(_logTableModel);
+
+    // progress of operations running in worker threads
+    _progressBar->setRange(0, 0);
+    _progressBar->hide();
+    _cancelButton->hide();
+    ui->windowLayout->addWidget(_progressBar);
+    ui->windowLayout->addWidget(_cancelButton);
+
+    // latency of queries (collected by Query), shown on demand
+    _statisticsButton->setCheckable(true);
+    _statisticsPanel->setReadOnly(true);
+    _statisticsPanel->setLineWrapMode(QPlainTextEdit::NoWrap);
+    _statisticsPanel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    _statisticsPanel->hide();
+    ui->windowLayout->addWidget(_statisticsButton);
+    ui->windowLayout->addWidget(_statisticsPanel);
+
+    // images of records of transaction double-clicked in tracking table
+    _imagesPanel->setReadOnly(true);
+    _imagesPanel->setLineWrapMode(QPlainTextEdit::NoWrap);
+    _imagesPanel->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    _imagesPanel->hide();
+    ui->windowLayout->addWidget(_imagesPanel);
+
     // enable state buttons
     const int noOfDatabases = session->noOfDatabases();
     QList<buttonType> buttonsToEnable { buttonType::ADD_DB };
@@ -59,14 +93,206 @@ MainWindow::MainWindow(Session * session, QWidget * parent):
     connect(ui->handleDbButtons[buttonType::REFRESH], &QPushButton::clicked,
             this, &MainWindow::refreshButtonClicked);
     connect(ui->connectToServerButton, &QPushButton::clicked, this, &MainWindow::connectToServerButtonClicked);
+    connect(_cancelButton, &QPushButton::clicked, this, &MainWindow::cancelButtonClicked);
+    connect(_statisticsButton, &QPushButton::toggled, this, &MainWindow::statisticsButtonClicked);
+    connect(ui->logTableView, &QTableView::doubleClicked, this, &MainWindow::logTableDoubleClicked);
     connect(ui->quitButton, &QPushButton::clicked, this, &QApplication::quit);
 }
 
 MainWindow::~MainWindow() {
 
+    for (auto it: _workerThreads.keys())
+        stopWorker(it);
     delete ui;
 }
 
+// one worker (and thread) per database, created on first use
+DatabaseWorker * MainWindow::worker(const QUuid ID) {
+
+    if (_workers.contains(ID))
+        return _workers.value(ID);
+
+    QThread * const workerThread = new QThread(this);
+    DatabaseWorker * const newWorker =
+        new DatabaseWorker(_currentSession->db(ID), _currentSession->systemDatabase()->connectionName());
+    newWorker->moveToThread(workerThread);
+    connect(workerThread, &QThread::finished, newWorker, &QObject::deleteLater);
+
+    connect(newWorker, &DatabaseWorker::connected, this,
+            [this, ID](const bool connectionEstablished, const QString & error,
+                       const QStringList & settingsList) -> void {
+
+        this->setIdle();
+        Database * const connectedDB = _currentSession->db(ID);
+        if (connectedDB == nullptr)
+            return;
+
+        connectedDB->connectionResult(connectionEstablished);
+        if (!connectionEstablished) {
+
+            ErrorMessage::critical(error.isEmpty()
+                ? QStringLiteral("Nepodařilo se připojit k uživatelské databázi.") : error);
+            return;
+        }
+
+        // user may have switched to other database in the meantime
+        if (ID != _currentSession->currentUserDatabaseID())
+            return;
+
+        QMap<Database::dbSettings, QString> dbSettings = DatabaseWorker::settingsFromList(settingsList);
+        this->fillFormWithSettings(dbSettings);
+        if (_currentSession->isUserDbNew()) {
+
+            QList<buttonType> buttonsToEnable { buttonType::SAVE };
+            this->enableButtons(ui->handleDbButtons, buttonsToEnable);
+        }
+    });
+
+    connect(newWorker, &DatabaseWorker::settingsRetrieved, this,
+            [this, ID](const bool settingsRetrieved, const QStringList & settingsList) -> void {
+
+        if (settingsRetrieved && ID == _currentSession->currentUserDatabaseID()) {
+
+            QMap<Database::dbSettings, QString> dbSettings = DatabaseWorker::settingsFromList(settingsList);
+            this->fillFormWithSettings(dbSettings);
+        }
+    });
+
+    connect(newWorker, &DatabaseWorker::progress, this,
+            [this](const int stage, const int done) -> void {
+
+        const QString stageLabel = (stage == int(Database::LOADING_LOG))
+            ? QStringLiteral("Načítání záznamů z logu: ") : QStringLiteral("Zápis do sledovací tabulky: ");
+        _progressBar->setFormat(stageLabel + QString::number(done));
+    });
+
+    connect(newWorker, &DatabaseWorker::refreshed, this,
+            [this, ID](const bool dbTrackingRefreshed, const bool cancelled, const int transactions,
+                   const int rows, const double rowsPerSecond) -> void {
+
+        this->setIdle();
+        this->refreshStatisticsPanel();
+
+        if (cancelled) {
+
+            ErrorMessage::information(QStringLiteral("Aktualizace záznamů byla přerušena."));
+            return;
+        }
+        if (!dbTrackingRefreshed) {
+
+            ErrorMessage::critical(QStringLiteral("Záznamy o provedených změnách se nepodařilo aktualizovat."));
+            return;
+        }
+
+        // new rows are shown from the top
+        if (ID == _currentSession->currentUserDatabaseID())
+            this->fillLogTableContents();
+
+        const StatementCacheStatistics cacheStatistics = StatementCache::statistics();
+
+        // display message box
+        ErrorMessage::information(QStringLiteral("Záznamy o provedených změnách v databázi byly aktualizovány.") +
+            QStringLiteral("\n(transakcí: ") + QString::number(transactions) +
+            QStringLiteral(", uloženo záznamů: ") + QString::number(rows) +
+            QStringLiteral(", záznamů/s: ") + QString::number(rowsPerSecond, 'f', 0) +
+            QStringLiteral(")\n(připravené dotazy - použito z cache: ") +
+            QString::number(cacheStatistics._statementHits) + QStringLiteral(", nově připraveno: ") +
+            QString::number(cacheStatistics._statementMisses) + QStringLiteral(")"));
+    });
+
+    connect(newWorker, &DatabaseWorker::migrated, this, [this, ID](const bool tableMigrated) -> void {
+
+        this->setIdle();
+        if (!tableMigrated) {
+
+            ErrorMessage::critical(QStringLiteral("Sledovací tabulku se nepodařilo převést na nové uspořádání."));
+            return;
+        }
+
+        // refresh which asked for migration continues
+        this->setBusy(ID, QStringLiteral("Načítání záznamů z logu..."));
+        QMetaObject::invokeMethod(this->worker(ID), "refresh", Qt::QueuedConnection);
+    });
+
+    connect(newWorker, &DatabaseWorker::transactionImagesLoaded, this,
+            [this](const bool imagesLoaded, const QString & imagesText) -> void {
+
+        this->setIdle();
+        if (!imagesLoaded) {
+
+            ErrorMessage::warning(QStringLiteral("Obrazy záznamů transakce se nepodařilo načíst."));
+            return;
+        }
+
+        // transaction is not in log any more and was harvested without images
+        _imagesPanel->setPlainText(imagesText.isEmpty()
+            ? QStringLiteral("Obrazy záznamů transakce nejsou k dispozici.") : imagesText);
+        _imagesPanel->show();
+    });
+
+    _workerThreads.insert(ID, workerThread);
+    _workers.insert(ID, newWorker);
+    workerThread->start();
+
+    return newWorker;
+}
+
+void MainWindow::stopWorker(const QUuid ID) {
+
+    if (!_workerThreads.contains(ID))
+        return;
+
+    // running operation is cancelled first (otherwise GUI waits until it ends)
+    Database * const workerDB = _currentSession->db(ID);
+    if (workerDB != nullptr)
+        workerDB->requestCancel();
+
+    // worker is deleted (in its thread) when thread finishes
+    QThread * const workerThread = _workerThreads.take(ID);
+    _workers.remove(ID);
+    workerThread->quit();
+    workerThread->wait();
+    delete workerThread;
+
+    // next worker of database starts without cancellation
+    if (workerDB != nullptr)
+        workerDB->resetCancel();
+    return;
+}
+
+// only one long-running operation at a time (buttons are disabled meanwhile)
+void MainWindow::setBusy(const QUuid ID, const QString & stageLabel) {
+
+    _busyDatabaseID = ID;
+    _enabledBeforeBusy.clear();
+
+    QList<QPushButton *> buttons = ui->switchDbButtons.values() + ui->handleDbButtons.values();
+    buttons << ui->connectToServerButton;
+    for (auto it: buttons) {
+
+        _enabledBeforeBusy.insert(it, it->isEnabled());
+        it->setEnabled(false);
+    }
+
+    _progressBar->setFormat(stageLabel);
+    _progressBar->show();
+    _cancelButton->setEnabled(true);
+    _cancelButton->show();
+    return;
+}
+
+void MainWindow::setIdle() {
+
+    for (auto it = _enabledBeforeBusy.cbegin(); it != _enabledBeforeBusy.cend(); ++it)
+        it.key()->setEnabled(it.value());
+    _enabledBeforeBusy.clear();
+
+    _progressBar->hide();
+    _cancelButton->hide();
+    _busyDatabaseID = QUuid();
+    return;
+}
+
 bool MainWindow::switchDbActionAfterButtonClicked(const Database::dbPosition switchToDbPos) {
 
     QUuid dbAfterSwitchID = QUuid();
@@ -81,14 +307,10 @@ bool MainWindow::switchDbActionAfterButtonClicked(const Database::dbPosition swi
 
         this->fillLogTableContents();
 
-        // if current (after switch) db is connected => display its settings
+        // if current (after switch) db is connected => display its settings (when retrieved)
         Database * const newDB = _currentSession->db(_currentSession->currentUserDatabaseID());
-        if (newDB->connectionEstablished()) {
-
-            QMap<Database::dbSettings, QString> dbSettings;
-            if (_currentSession->retrieveUserDbSettings(dbSettings))
-                this->fillFormWithSettings(dbSettings);
-        }
+        if (newDB->connectionEstablished())
+            QMetaObject::invokeMethod(this->worker(newDB->ID()), "retrieveSettings", Qt::QueuedConnection);
 
         this->enableButtons(ui->switchDbButtons, { buttonType::PREVIOUS_DB, buttonType::NEXT_DB });
         if (newDB == _currentSession->dbs().first())
@@ -152,12 +374,17 @@ void MainWindow::fillFormWithSettings(QMap<Database::dbSettings, QString> & sett
 void MainWindow::fillLogTableContents() {
 
     Database * currentDB = _currentSession->db(_currentSession->currentUserDatabaseID());
-    currentDB->initializeLogTable(currentDB->logTableName());
 
-    delete ui->logTableView;
-    ui->logTableView = new QTableView();
-    ui->logTableView->setModel(currentDB->logTable());
-    ui->windowLayout->insertWidget(3, ui->logTableView);
+    _logTableModel->setTable(sql::systemConnection, currentDB->logTableName(), currentDB->trackedRows());
+    _imagesPanel->clear();
+    _imagesPanel->hide();
+    return;
+}
+
+void MainWindow::refreshStatisticsPanel() {
+
+    if (_statisticsPanel->isVisible())
+        _statisticsPanel->setPlainText(QueryStatistics::report());
     return;
 }
 
@@ -212,6 +439,8 @@ bool MainWindow::addDbButtonClicked() {
 
     if (!newDbID.isNull()) {
 
+        // tracking table does not exist until configuration is saved
+        _logTableModel->clear();
         fillFormWithBasicData(newDbID);
         _currentSession->changeCurrentDbTo(newDbID);
         return true;
@@ -232,6 +461,9 @@ bool MainWindow::removeDbButtonClicked() {
             return false;
     }
 
+    // worker of removed database is no longer needed
+    this->stopWorker(_currentSession->currentUserDatabaseID());
+
     // erase from list of user DBs
     QUuid currentDatabaseID = QUuid();
     _currentSession->removeUserDatabase(currentDatabaseID);
@@ -260,6 +492,13 @@ bool MainWindow::removeDbButtonClicked() {
     }
 
     _currentSession->changeCurrentDbTo(currentDatabaseID);
+
+    // tracking table of removed database has been dropped
+    if (_currentSession->noOfDatabases() > 0)
+        this->fillLogTableContents();
+    else
+        _logTableModel->clear();
+
     return true;
 }
 
@@ -320,19 +559,37 @@ bool MainWindow::saveButtonClicked() {
     return false;
 }
 
+// [slot]
 bool MainWindow::refreshButtonClicked() {
 
-    if (_currentSession->db(_currentSession->currentUserDatabaseID())->connectionEstablished()) {
+    Database * const currentDB = _currentSession->db(_currentSession->currentUserDatabaseID());
 
-        bool dbTrackingRefreshed = false;
+    if (currentDB->connectionEstablished()) {
 
-        dbTrackingRefreshed = _currentSession->loadRecordsFromLog();
-        // _currentSession->loadRecordsFromLogBackup();
+        if (this->isBusy())
+            return false;
 
-        // display message box
-        ErrorMessage::information(QStringLiteral("Záznamy o provedených změnách v databázi byly aktualizovány."));
+        // rebuild of older table may take long => user decides (older table is harvested as it is)
+        bool needsMigration = false;
+        const QSqlDatabase * const systemConnection = _currentSession->systemDatabase()->dbConnection();
+        if (currentDB->logTableNeedsMigration(systemConnection, needsMigration) && needsMigration &&
+            ErrorMessage::question(QStringLiteral("Sledovací tabulka databáze má starší uspořádání. ") +
+                QStringLiteral("Převod může u velké tabulky trvat dlouho a nelze jej přerušit.\n") +
+                QStringLiteral("Přejete si tabulku převést před aktualizací?")) == QMessageBox::Yes) {
 
-        return dbTrackingRefreshed;
+            // result is delivered by DatabaseWorker::migrated (refresh follows)
+            this->setBusy(currentDB->ID(), QStringLiteral("Převod sledovací tabulky..."));
+            _cancelButton->setEnabled(false);
+            QMetaObject::invokeMethod(this->worker(currentDB->ID()), "migrateLogTable", Qt::QueuedConnection);
+
+            return true;
+        }
+
+        // result is delivered by DatabaseWorker::refreshed
+        this->setBusy(currentDB->ID(), QStringLiteral("Načítání záznamů z logu..."));
+        QMetaObject::invokeMethod(this->worker(currentDB->ID()), "refresh", Qt::QueuedConnection);
+
+        return true;
     }
 
     ErrorMessage::warning(QStringLiteral("Databáze není připojená."));
@@ -342,20 +599,64 @@ bool MainWindow::refreshButtonClicked() {
 // [slot]
 bool MainWindow::connectToServerButtonClicked() {
 
-    if (_currentSession->connectToUserDatabase()) {
+    if (_currentSession->noOfDatabases() == 0 ||
+        _currentSession->db(_currentSession->currentUserDatabaseID())->dbName().isEmpty()) {
 
-        QMap<Database::dbSettings, QString> dbSettings;
+        ErrorMessage::warning(QStringLiteral("Nepodařilo se připojit k uživatelské databázi."));
+        return false;
+    }
 
-        if (_currentSession->retrieveUserDbSettings(dbSettings)) {
+    if (this->isBusy())
+        return false;
 
-            this->fillFormWithSettings(dbSettings);
-            if (_currentSession->isUserDbNew()) {
+    Database * const currentDB = _currentSession->db(_currentSession->currentUserDatabaseID());
 
-                QList<buttonType> buttonsToEnable { buttonType::SAVE };
-                this->enableButtons(ui->handleDbButtons, buttonsToEnable);
-            }
-            return true;
-        }
+    // worker clones the connection => only connection string is set here
+    currentDB->setConnectionString(currentDB->connectionProperties());
+
+    // result is delivered by DatabaseWorker::connected
+    this->setBusy(currentDB->ID(), QStringLiteral("Připojování k databázi..."));
+    QMetaObject::invokeMethod(this->worker(currentDB->ID()), "connectToServer", Qt::QueuedConnection);
+
+    return true;
+}
+
+// [slot]
+void MainWindow::cancelButtonClicked() {
+
+    Database * const busyDB = _currentSession->db(_busyDatabaseID);
+    if (busyDB != nullptr) {
+
+        // operation stops at nearest checkpoint (row of log or batch of tracking table)
+        busyDB->requestCancel();
+        _cancelButton->setEnabled(false);
     }
-    return false;
+    return;
+}
+
+// [slot] images are loaded on demand only (tracking table holds metadata)
+void MainWindow::logTableDoubleClicked(const QModelIndex & index) {
+
+    Database * const currentDB = _currentSession->db(_currentSession->currentUserDatabaseID());
+    if (!index.isValid() || currentDB == nullptr || !currentDB->connectionEstablished() || this->isBusy())
+        return;
+
+    // columns TransactionID, BeginLSN and EndLSN of tracking table
+    const QString transactionID = _logTableModel->index(index.row(), 2).data().toString();
+    const QString beginLSN = _logTableModel->index(index.row(), 6).data().toString();
+    const QString endLSN = _logTableModel->index(index.row(), 7).data().toString();
+
+    // result is delivered by DatabaseWorker::transactionImagesLoaded
+    this->setBusy(currentDB->ID(), QStringLiteral("Načítání obrazů záznamů..."));
+    QMetaObject::invokeMethod(this->worker(currentDB->ID()), "loadTransactionImages", Qt::QueuedConnection,
+                              Q_ARG(QString, transactionID), Q_ARG(QString, beginLSN), Q_ARG(QString, endLSN));
+    return;
+}
+
+// [slot]
+void MainWindow::statisticsButtonClicked(const bool showStatistics) {
+
+    _statisticsPanel->setVisible(showStatistics);
+    this->refreshStatisticsPanel();
+    return;
 }
@@ -7,11 +7,18 @@
 #define MAINWINDOW_H
 
 #include <QList>
+#include <QModelIndex>
 #include <QMap>
 #include <QPair>
+#include <QPlainTextEdit>
+#include <QProgressBar>
+#include <QPushButton>
 #include <QString>
+#include <QThread>
 #include <QUuid>
 #include <QVector>
+#include "dbworker.h"
+#include "logtablemodel.h"
 #include "ui/ui_mainwindow.h"
 
 class MainWindow: public QDialog {
@@ -35,14 +42,24 @@ class MainWindow: public QDialog {
         bool saveButtonClicked();
         bool refreshButtonClicked();
         bool connectToServerButtonClicked();
+        void cancelButtonClicked();
+        void statisticsButtonClicked(const bool);
+        void logTableDoubleClicked(const QModelIndex &);
 
     private:
+        DatabaseWorker * worker(const QUuid);
+        void stopWorker(const QUuid);
+        inline bool isBusy() const { return !_busyDatabaseID.isNull(); }
+        void setBusy(const QUuid, const QString &);
+        void setIdle();
+
         bool switchDbActionAfterButtonClicked(const Database::dbPosition);
         void saveValue();
         void refreshDbIDLabel(const QUuid ID, const int databaseID);
         void fillFormWithBasicData(const QUuid);
         void fillFormWithSettings(QMap<Database::dbSettings, QString> &);
         void fillLogTableContents();
+        void refreshStatisticsPanel();
 
         void clearWindowContents() const;
         void enableButtons(const QMap<buttonType, QPushButton *> &,
@@ -53,6 +70,16 @@ class MainWindow: public QDialog {
                             const QList<buttonType> &>>) const;
 
         Session * _currentSession;
+        QMap<QUuid, QThread *> _workerThreads;
+        QMap<QUuid, DatabaseWorker *> _workers;
+        QProgressBar * _progressBar;
+        QPushButton * _cancelButton;
+        QPushButton * _statisticsButton;
+        QPlainTextEdit * _statisticsPanel;
+        QPlainTextEdit * _imagesPanel;
+        LogTableModel * _logTableModel;
+        QUuid _busyDatabaseID;
+        QMap<QPushButton *, bool> _enabledBeforeBusy;
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,120 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include "objectnamecache.h"
+#include "query.h"
+
+// rows of queries (columns in order of select list)
+struct AllocationUnitRow {
+
+    qint64 _allocationUnitID;
+    QString _objectName;
+};
+
+bool ObjectNameCache::load(const QSqlDatabase * userConnection, const QString & resources,
+                           const QString & dbName) {
+
+    const QString resourceForQuery = resources + QStringLiteral("retrieve_allocation_unit_names.sql");
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":dbName"), dbName) };
+
+    Query * const queryToExecute = new Query(userConnection, customBindings);
+    queryToExecute->setForwardOnly(true);
+
+    QHash<qint64, QString> names;
+    const bool namesLoaded = queryToExecute->prepareQuery(resourceForQuery) &&
+        queryToExecute->processSelectQuery(
+            mapColumns(&AllocationUnitRow::_allocationUnitID, &AllocationUnitRow::_objectName),
+            [&names](const AllocationUnitRow & row) -> bool
+                { names.insert(row._allocationUnitID, row._objectName); return true; });
+    delete queryToExecute;
+
+    if (namesLoaded) {
+
+        this->_names.swap(names);
+        this->_pendingUnits.clear();
+        this->_loaded = true;
+    }
+    return namesLoaded;
+}
+
+bool ObjectNameCache::refresh(const QSqlDatabase * userConnection, const QString & resources,
+                              const QString & dbName) {
+
+    if (this->_pendingUnits.isEmpty())
+        return true;
+
+    const QString resourceForQuery = resources + QStringLiteral("retrieve_allocation_unit_name.sql");
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":dbName"), dbName) };
+
+    Query * const queryToExecute = new Query(userConnection, customBindings);
+    bool namesRefreshed = queryToExecute->prepareQuery(resourceForQuery);
+
+    // statement is prepared once and executed for every pending unit
+    for (auto it = this->_pendingUnits.begin(); namesRefreshed && it != this->_pendingUnits.end(); ) {
+
+        queryToExecute->setBinding(0, QVariant(*it));
+
+        // unit which no longer exists (object was dropped) is cached with empty name
+        AllocationUnitRow row { *it, QString() };
+        namesRefreshed = queryToExecute->processSelectQuery(
+            mapColumns(&AllocationUnitRow::_allocationUnitID, &AllocationUnitRow::_objectName),
+            [&row](const AllocationUnitRow & foundRow) -> bool { row = foundRow; return false; });
+
+        if (namesRefreshed) {
+
+            this->_names.insert(*it, row._objectName);
+            it = this->_pendingUnits.erase(it);
+        }
+    }
+    delete queryToExecute;
+    return namesRefreshed;
+}
+
+void ObjectNameCache::clear() {
+
+    this->_names.clear();
+    this->_pendingUnits.clear();
+    this->_loaded = false;
+    return;
+}
+
+QString ObjectNameCache::name(const qint64 allocationUnitID) {
+
+    // records without allocation unit (begin/commit of transaction, ...)
+    if (allocationUnitID == 0)
+        return QString();
+
+    const auto cachedName = this->_names.constFind(allocationUnitID);
+    if (cachedName != this->_names.cend())
+        return cachedName.value();
+
+    this->_pendingUnits.insert(allocationUnitID);
+    return QString();
+}
+
+const QStringList & ObjectNameCache::ddlOperations() {
+
+    static const QStringList operations { QStringLiteral("LOP_CREATE_ALLOCCHAIN"),
+        QStringLiteral("LOP_HOBT_DDL"), QStringLiteral("LOP_CREATE_INDEX"),
+        QStringLiteral("LOP_DROP_INDEX") };
+
+    return operations;
+}
+
+void ObjectNameCache::noteOperation(const QString & operation, const qint64 allocationUnitID) {
+
+    if (allocationUnitID != 0 && ObjectNameCache::ddlOperations().contains(operation)) {
+
+        this->_names.remove(allocationUnitID);
+        this->_pendingUnits.insert(allocationUnitID);
+    }
+    return;
+}
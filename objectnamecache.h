@@ -0,0 +1,47 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef OBJECTNAMECACHE_H
+#define OBJECTNAMECACHE_H
+
+#include <QHash>
+#include <QSet>
+#include <QSqlDatabase>
+#include <QString>
+#include <QStringList>
+
+// names of objects (schema.object) owning allocation units of one database; log records carry
+// only AllocUnitId, names are resolved client-side instead of joining catalog views for every
+// log record. Whole catalog is loaded once, later only units which are unknown or touched
+// by DDL records are looked up again (after the log has been read - connection is busy
+// while log records are fetched)
+class ObjectNameCache {
+
+    public:
+        ObjectNameCache(): _loaded(false) {}
+        ~ObjectNameCache() {}
+
+        inline bool isLoaded() const { return _loaded; }
+        inline bool isPending(const qint64 ID) const { return _pendingUnits.contains(ID); }
+        inline int size() const { return _names.size(); }
+        // operations which change allocation units
+        static const QStringList & ddlOperations();
+
+        bool load(const QSqlDatabase *, const QString &, const QString &);
+        bool refresh(const QSqlDatabase *, const QString &, const QString &);
+        void clear();
+
+        // empty name = no object or not known yet (unit is then looked up by refresh)
+        QString name(const qint64);
+        // DDL records (allocation chains, HoBt changes) make cached name of unit obsolete
+        void noteOperation(const QString &, const qint64);
+
+    private:
+        QHash<qint64, QString> _names;
+        QSet<qint64> _pendingUnits;
+        bool _loaded;
+};
+
+#endif // OBJECTNAMECACHE_H
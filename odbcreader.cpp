@@ -0,0 +1,344 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include <QRegularExpression>
+#include <QStringList>
+#include "odbcreader.h"
+
+#ifdef DBLOGGER_NATIVE_ODBC
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#endif
+#include <sql.h>
+#include <sqlext.h>
+
+static_assert(sizeof(SQLWCHAR) == sizeof(quint16), "ODBC must use UTF-16 wide characters");
+static_assert(sizeof(SQLLEN) == sizeof(qintptr), "unexpected size of SQLLEN");
+#endif
+
+// value of column in row (nullptr = NULL or not fetched), length in characters
+const quint16 * OdbcRowSet::value(const int column, const int row, int & length) const {
+
+    if (column >= this->_widths.size() || this->_widths.at(column) == 0 || row >= this->_size)
+        return nullptr;
+
+    const qintptr indicator = this->_indicators.at(column).at(row);
+    if (indicator < 0 && indicator != -4 /* SQL_NO_TOTAL */)
+        return nullptr;
+
+    // truncated value is cut to width of buffer
+    const int width = this->_widths.at(column);
+    length = (indicator == -4) ? width : qMin(width, int(indicator / sizeof(quint16)));
+    return (this->_buffers.at(column).constData() + row * (width + 1));
+}
+
+bool OdbcRowSet::isValid(const int row) const {
+
+    // SQL_ROW_SUCCESS = 0, SQL_ROW_SUCCESS_WITH_INFO = 6
+    return (row < this->_size && (this->_rowStatus.at(row) == 0 || this->_rowStatus.at(row) == 6));
+}
+
+bool OdbcRowSet::isNull(const int column, const int row) const {
+
+    int length = 0;
+    return (this->value(column, row, length) == nullptr);
+}
+
+QString OdbcRowSet::text(const int column, const int row) const {
+
+    int length = 0;
+    const quint16 * const characters = this->value(column, row, length);
+
+    return ((characters == nullptr) ? QString()
+        : QString(reinterpret_cast<const QChar *>(characters), length));
+}
+
+// fn_dblog returns times as text (yyyy/MM/dd HH:mm:ss:zzz), stand-in servers use ISO format
+QDateTime OdbcRowSet::dateTime(const int column, const int row) const {
+
+    int length = 0;
+    const quint16 * const characters = this->value(column, row, length);
+    if (characters == nullptr || length == 0)
+        return QDateTime();
+
+    const QString time = QString::fromRawData(reinterpret_cast<const QChar *>(characters), length);
+    const QDateTime dateTime = QDateTime::fromString(time, QStringLiteral("yyyy/MM/dd HH:mm:ss:zzz"));
+    return (dateTime.isValid() ? dateTime : QDateTime::fromString(time, Qt::ISODateWithMs));
+}
+
+// hexadecimal text (vlf:block:slot, optionally with 0x prefix) decoded without temporary strings
+LSN OdbcRowSet::lsn(const int column, const int row) const {
+
+    int length = 0;
+    const quint16 * characters = this->value(column, row, length);
+    if (characters == nullptr)
+        return LSN();
+
+    if (length > 2 && characters[0] == '0' && (characters[1] == 'x' || characters[1] == 'X')) {
+
+        characters += 2;
+        length -= 2;
+    }
+
+    quint64 parts[3] = { 0, 0, 0 };
+    int part = 0;
+    for (int i = 0; i < length; ++i) {
+
+        const quint16 character = characters[i];
+        if (character == ':') {
+
+            if (++part > 2)
+                return LSN();
+            continue;
+        }
+
+        int digit = -1;
+        if (character >= '0' && character <= '9')
+            digit = character - '0';
+        else if (character >= 'a' && character <= 'f')
+            digit = character - 'a' + 10;
+        else if (character >= 'A' && character <= 'F')
+            digit = character - 'A' + 10;
+        else if (character == ' ')
+            continue;
+        else
+            return LSN();
+
+        parts[part] = (parts[part] << 4) | quint64(digit);
+    }
+
+    return ((part == 2) ? LSN(quint32(parts[0]), quint32(parts[1]), quint16(parts[2])) : LSN());
+}
+
+OdbcBulkReader::OdbcBulkReader(const int rowArraySize):
+    _rowArraySize(qMax(1, rowArraySize)), _environment(nullptr), _connection(nullptr) {}
+
+OdbcBulkReader::~OdbcBulkReader() {
+
+    this->disconnect();
+}
+
+bool OdbcBulkReader::isAvailable() {
+
+#ifdef DBLOGGER_NATIVE_ODBC
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ODBC connection string of Qt connection (QSQLITE file is opened through SQLite ODBC driver)
+QString OdbcBulkReader::connectionString(const QSqlDatabase & connection) {
+
+    if (connection.driverName() == QStringLiteral("QSQLITE"))
+        return (QStringLiteral("DRIVER=SQLite3;Database=") + connection.databaseName() + QStringLiteral(";"));
+
+    QString connectionDataSet = connection.databaseName();
+    if (!connection.userName().isEmpty())
+        connectionDataSet += QStringLiteral(";Uid=") + connection.userName();
+    if (!connection.password().isEmpty())
+        connectionDataSet += QStringLiteral(";Pwd=") + connection.password();
+
+    return connectionDataSet;
+}
+
+#ifdef DBLOGGER_NATIVE_ODBC
+
+// diagnostic record of failed call is kept as last error
+bool OdbcBulkReader::succeeded(const short returnCode, const short handleType, void * const handle) {
+
+    if (SQL_SUCCEEDED(returnCode))
+        return true;
+
+    SQLWCHAR state[6] = { 0 };
+    SQLWCHAR message[SQL_MAX_MESSAGE_LENGTH] = { 0 };
+    SQLINTEGER nativeError = 0;
+    SQLSMALLINT messageLength = 0;
+
+    if (handle != nullptr && SQL_SUCCEEDED(SQLGetDiagRecW(handleType, handle, 1, state, &nativeError,
+                                                          message, SQL_MAX_MESSAGE_LENGTH, &messageLength)))
+        this->_lastError = QString(reinterpret_cast<const QChar *>(state), 5) + QStringLiteral(": ") +
+            QString(reinterpret_cast<const QChar *>(message), qMin(int(messageLength), SQL_MAX_MESSAGE_LENGTH - 1));
+    else
+        this->_lastError = QStringLiteral("Chyba ODBC (") + QString::number(returnCode) + QStringLiteral(")");
+
+    return false;
+}
+
+bool OdbcBulkReader::connect(const QString & connectionDataSet) {
+
+    this->disconnect();
+
+    if (!this->succeeded(SQLAllocHandle(SQL_HANDLE_ENV, SQL_NULL_HANDLE, &(this->_environment)),
+                         SQL_HANDLE_ENV, nullptr) ||
+        !this->succeeded(SQLSetEnvAttr(this->_environment, SQL_ATTR_ODBC_VERSION,
+                                       reinterpret_cast<SQLPOINTER>(SQL_OV_ODBC3), 0),
+                         SQL_HANDLE_ENV, this->_environment) ||
+        !this->succeeded(SQLAllocHandle(SQL_HANDLE_DBC, this->_environment, &(this->_connection)),
+                         SQL_HANDLE_ENV, this->_environment)) {
+
+        this->disconnect();
+        return false;
+    }
+
+    const SQLRETURN returnCode = SQLDriverConnectW(this->_connection, nullptr,
+        reinterpret_cast<SQLWCHAR *>(const_cast<ushort *>(connectionDataSet.utf16())), SQL_NTS,
+        nullptr, 0, nullptr, SQL_DRIVER_NOPROMPT);
+
+    if (!this->succeeded(returnCode, SQL_HANDLE_DBC, this->_connection)) {
+
+        SQLFreeHandle(SQL_HANDLE_DBC, this->_connection);
+        this->_connection = nullptr;
+        this->disconnect();
+        return false;
+    }
+    return true;
+}
+
+void OdbcBulkReader::disconnect() {
+
+    if (this->_connection != nullptr) {
+
+        SQLDisconnect(this->_connection);
+        SQLFreeHandle(SQL_HANDLE_DBC, this->_connection);
+        this->_connection = nullptr;
+    }
+    if (this->_environment != nullptr) {
+
+        SQLFreeHandle(SQL_HANDLE_ENV, this->_environment);
+        this->_environment = nullptr;
+    }
+    return;
+}
+
+// widths: buffer size [characters] of every column of select list (0 = column is skipped);
+// handler gets every fetched block and returns false to stop fetching
+bool OdbcBulkReader::select(const QString & queryString, const QVector<QPair<QString, QString>> & parameters,
+                            const QVector<int> & widths,
+                            const std::function<bool(const OdbcRowSet &)> & rowSetHandler) {
+
+    static const QRegularExpression placeholder(QStringLiteral("(?<![\\w:]):[A-Za-z_]\\w*"));
+
+    if (this->_connection == nullptr)
+        return false;
+
+    SQLHSTMT statement = SQL_NULL_HSTMT;
+    if (!this->succeeded(SQLAllocHandle(SQL_HANDLE_STMT, this->_connection, &statement),
+                         SQL_HANDLE_DBC, this->_connection))
+        return false;
+
+    // named parameters are replaced by markers in order of appearance
+    QString statementText = queryString;
+    QStringList parameterValues;
+    QVector<bool> parameterIsNull;
+    QRegularExpressionMatch match;
+    int position = 0;
+    while ((match = placeholder.match(statementText, position)).hasMatch()) {
+
+        QString value;
+        bool isNull = true;
+        for (auto it: parameters)
+            if (it.first == match.captured()) {
+                value = it.second;
+                isNull = it.second.isNull();
+            }
+
+        parameterValues << value;
+        parameterIsNull << isNull;
+        statementText.replace(match.capturedStart(), match.capturedLength(), QChar('?'));
+        position = match.capturedStart() + 1;
+    }
+
+    QVector<SQLLEN> parameterIndicators(parameterValues.size());
+    bool statementExecuted = this->succeeded(SQLPrepareW(statement,
+        reinterpret_cast<SQLWCHAR *>(const_cast<ushort *>(statementText.utf16())), SQL_NTS),
+        SQL_HANDLE_STMT, statement);
+
+    for (int i = 0; i < parameterValues.size() && statementExecuted; ++i) {
+
+        parameterIndicators[i] = parameterIsNull.at(i) ? SQL_NULL_DATA : SQL_NTS;
+        statementExecuted = this->succeeded(SQLBindParameter(statement, SQLUSMALLINT(i + 1), SQL_PARAM_INPUT,
+            SQL_C_WCHAR, SQL_WVARCHAR, SQLULEN(qMax(1, parameterValues.at(i).size())), 0,
+            reinterpret_cast<SQLPOINTER>(const_cast<ushort *>(parameterValues.at(i).utf16())),
+            0, &(parameterIndicators[i])), SQL_HANDLE_STMT, statement);
+    }
+
+    // column-wise binding of whole block of rows
+    OdbcRowSet rowSet;
+    SQLULEN rowsFetched = 0;
+    rowSet._widths = widths;
+    rowSet._buffers.resize(widths.size());
+    rowSet._indicators.resize(widths.size());
+    rowSet._rowStatus.resize(this->_rowArraySize);
+
+    if (statementExecuted)
+        statementExecuted =
+            this->succeeded(SQLSetStmtAttr(statement, SQL_ATTR_ROW_BIND_TYPE,
+                reinterpret_cast<SQLPOINTER>(SQL_BIND_BY_COLUMN), 0), SQL_HANDLE_STMT, statement) &&
+            this->succeeded(SQLSetStmtAttr(statement, SQL_ATTR_ROW_ARRAY_SIZE,
+                reinterpret_cast<SQLPOINTER>(SQLULEN(this->_rowArraySize)), 0), SQL_HANDLE_STMT, statement) &&
+            this->succeeded(SQLSetStmtAttr(statement, SQL_ATTR_ROW_STATUS_PTR,
+                rowSet._rowStatus.data(), 0), SQL_HANDLE_STMT, statement) &&
+            this->succeeded(SQLSetStmtAttr(statement, SQL_ATTR_ROWS_FETCHED_PTR,
+                &rowsFetched, 0), SQL_HANDLE_STMT, statement) &&
+            this->succeeded(SQLExecute(statement), SQL_HANDLE_STMT, statement);
+
+    for (int column = 0; column < widths.size() && statementExecuted; ++column) {
+
+        if (widths.at(column) == 0)
+            continue;
+
+        rowSet._buffers[column].resize(this->_rowArraySize * (widths.at(column) + 1));
+        rowSet._indicators[column].resize(this->_rowArraySize);
+        statementExecuted = this->succeeded(SQLBindCol(statement, SQLUSMALLINT(column + 1), SQL_C_WCHAR,
+            rowSet._buffers[column].data(), SQLLEN((widths.at(column) + 1) * sizeof(SQLWCHAR)),
+            reinterpret_cast<SQLLEN *>(rowSet._indicators[column].data())), SQL_HANDLE_STMT, statement);
+    }
+
+    while (statementExecuted) {
+
+        const SQLRETURN returnCode = SQLFetch(statement);
+        if (returnCode == SQL_NO_DATA)
+            break;
+        if (!this->succeeded(returnCode, SQL_HANDLE_STMT, statement)) {
+
+            statementExecuted = false;
+            break;
+        }
+
+        rowSet._size = int(rowsFetched);
+        if (!rowSetHandler(rowSet))
+            break;
+    }
+
+    SQLFreeHandle(SQL_HANDLE_STMT, statement);
+    return statementExecuted;
+}
+
+#else
+
+bool OdbcBulkReader::succeeded(const short, const short, void * const) {
+
+    this->_lastError = QStringLiteral("Přímé čtení přes ODBC není v této verzi k dispozici.");
+    return false;
+}
+
+bool OdbcBulkReader::connect(const QString &) {
+
+    return this->succeeded(-1, 0, nullptr);
+}
+
+void OdbcBulkReader::disconnect() {
+
+    return;
+}
+
+bool OdbcBulkReader::select(const QString &, const QVector<QPair<QString, QString>> &, const QVector<int> &,
+                            const std::function<bool(const OdbcRowSet &)> &) {
+
+    return this->succeeded(-1, 0, nullptr);
+}
+
+#endif
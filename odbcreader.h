@@ -0,0 +1,71 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef ODBCREADER_H
+#define ODBCREADER_H
+
+#include <functional>
+#include <QDateTime>
+#include <QPair>
+#include <QSqlDatabase>
+#include <QString>
+#include <QVector>
+#include "constants.h"
+#include "lsn.h"
+
+// block of rows fetched by one SQLFetch (column-wise bound UTF-16 buffers)
+class OdbcRowSet {
+
+    public:
+        OdbcRowSet(): _size(0) {}
+        ~OdbcRowSet() {}
+
+        inline int size() const { return _size; }
+        bool isValid(const int) const; // row was fetched without error
+        bool isNull(const int, const int) const;
+        QString text(const int, const int) const;
+        QDateTime dateTime(const int, const int) const;
+        LSN lsn(const int, const int) const;
+
+    private:
+        friend class OdbcBulkReader;
+
+        const quint16 * value(const int, const int, int &) const;
+
+        QVector<int> _widths; // [characters], 0 = column is not bound
+        QVector<QVector<quint16>> _buffers;
+        QVector<QVector<qintptr>> _indicators;
+        QVector<quint16> _rowStatus;
+        int _size;
+};
+
+// optional reader using ODBC directly (build with CONFIG+=native_odbc): statement is executed
+// with column-wise binding and SQL_ATTR_ROW_ARRAY_SIZE, values are decoded from fetched buffers
+// without QVariant; named parameters (:name) are bound positionally as strings
+class OdbcBulkReader {
+
+    public:
+        explicit OdbcBulkReader(const int = sql::odbcRowArraySize);
+        ~OdbcBulkReader();
+
+        static bool isAvailable();
+        static QString connectionString(const QSqlDatabase &);
+
+        bool connect(const QString &);
+        bool select(const QString &, const QVector<QPair<QString, QString>> &, const QVector<int> &,
+                    const std::function<bool(const OdbcRowSet &)> &);
+        void disconnect();
+        inline QString lastError() const { return _lastError; }
+
+    private:
+        bool succeeded(const short, const short, void * const);
+
+        const int _rowArraySize;
+        void * _environment;
+        void * _connection;
+        QString _lastError;
+};
+
+#endif // ODBCREADER_H
@@ -3,14 +3,43 @@
  This program is distributed under the terms of the GNU General Public License.
 *******************************************************************************/
 
-#include <QFile>
+#include <QElapsedTimer>
 #include <QRegularExpression>
 #include <QSqlError>
 #include <QSqlRecord>
 #include <QString>
+#include <QStringList>
 #include <QVariant>
 #include "query.h"
 #include "shared.h"
+#include "statementcache.h"
+
+Query::~Query() {
+
+    this->releaseStatement();
+}
+
+// statement is checked out of StatementCache for lifetime of Query (or until next prepare)
+bool Query::prepareStatement() {
+
+    if (!this->_cached)
+        return this->_query.prepare(this->_queryString);
+
+    this->_statementCheckedOut =
+        StatementCache::checkOut(this->_connectionName, this->_queryString, this->_query,
+                                 this->_statementGeneration);
+    return this->_statementCheckedOut;
+}
+
+void Query::releaseStatement() {
+
+    if (this->_statementCheckedOut)
+        StatementCache::checkIn(this->_connectionName, this->_queryString, this->_query,
+                                this->_statementGeneration);
+
+    this->_statementCheckedOut = false;
+    return;
+}
 
 void Query::setAllBindingsForProps(const DatabaseConnectionProps * const properties) {
 
@@ -20,54 +49,133 @@ void Query::setAllBindingsForProps(const DatabaseConnectionProps * const propert
     this->setBinding(QStringLiteral(":userName"), properties->userName());
 }
 
-void Query::setCustomBinding(const QString & placeholder, const QString & value) {
+QString Query::customBindingValue(const QString & placeholder) const {
 
-    const QString currentValue =
-        (value.contains(QRegularExpression(QStringLiteral("[^\\w]"))))
-            ? shared::leftSqBr + value + shared::rightSqBr : value;
-    this->_queryString.replace(placeholder, currentValue);
-    return;
+    static const QRegularExpression nonWordCharacter(QStringLiteral("[^\\w]"));
+
+    for (auto it : this->_clauses)
+        if (it.first == placeholder)
+            return it.second;
+
+    for (auto it : this->_customBindings)
+        if (it.first == placeholder)
+            return ((it.second.contains(nonWordCharacter))
+                ? shared::leftSqBr + it.second + shared::rightSqBr : it.second);
+
+    // not a custom binding => left for QSqlQuery
+    return placeholder;
+}
+
+bool Query::loadQueryString(const QString & resourcePath) {
+
+    SqlResource splitQuery;
+    if (!StatementCache::resource(resourcePath, splitQuery))
+        return false;
+
+    this->_resourcePath = resourcePath;
+
+    // set custom bindings
+    QString queryString = splitQuery._fragments.first();
+    for (int i = 0; i < splitQuery._placeholders.size(); ++i)
+        queryString += this->customBindingValue(splitQuery._placeholders.at(i)) +
+                       splitQuery._fragments.at(i + 1);
+
+    this->_queryString = queryString;
+    return true;
 }
 
 bool Query::prepareQuery(const QString & resourcePath) {
 
-    QFile resource(resourcePath);
-    resource.open(QIODevice::ReadOnly | QIODevice::Text);
-    const QByteArray queryFromResource = resource.readAll();
-    QString queryString(queryFromResource);
+    QElapsedTimer timer;
+    timer.start();
 
-    if (queryString.isEmpty())
+    // statement checked out before is returned under its own query string
+    this->releaseStatement();
+    if (!this->loadQueryString(resourcePath))
         return false;
-    this->_queryString = queryString;
 
-    // set custom bindings
-    for (auto it : this->_customBindings)
-        setCustomBinding(it.first, it.second);
+    const bool queryPrepared = this->prepareStatement();
+    QueryStatistics::record(resourcePath, this->_connectionName, PREPARE, timer.nsecsElapsed());
+    return queryPrepared;
+}
+
+// multi-row insert: row constructor following VALUES is repeated for every row
+// (values are then bound positionally, row after row)
+bool Query::prepareBatchQuery(const QString & resourcePath, const int noOfRows) {
+
+    QElapsedTimer timer;
+    timer.start();
+
+    this->releaseStatement();
+    if (noOfRows < 1 || !this->loadQueryString(resourcePath))
+        return false;
+
+    const int valuesClause =
+        this->_queryString.lastIndexOf(QStringLiteral("VALUES"), -1, Qt::CaseInsensitive);
+    if (valuesClause == -1)
+        return false;
 
-    return (this->_query.prepare(this->_queryString));
+    const int rowBegin = this->_queryString.indexOf(QChar('('), valuesClause);
+    const int rowEnd = this->_queryString.lastIndexOf(QChar(')'));
+    if (rowBegin == -1 || rowEnd < rowBegin)
+        return false;
+
+    const QString rowConstructor = this->_queryString.mid(rowBegin, rowEnd - rowBegin + 1);
+    QStringList rows;
+    rows.reserve(noOfRows);
+    for (int i = 0; i < noOfRows; ++i)
+        rows << rowConstructor;
+
+    this->_queryString.replace(rowBegin, rowEnd - rowBegin + 1, rows.join(QStringLiteral(", ")));
+    const bool queryPrepared = this->prepareStatement();
+    QueryStatistics::record(resourcePath, this->_connectionName, PREPARE, timer.nsecsElapsed());
+    return queryPrepared;
 }
 
 bool Query::processSelectQuery() {
 
-    if (this->_query.exec()) {
+    // materialize whole result
+    return this->processSelectQuery([this](const QueryRow & row) -> bool {
+
+        QVector<QVariant> values;
+        const int noOfColumns = this->_query.record().count();
+        values.reserve(noOfColumns);
+
+        // NULL values are kept (column index = position in row)
+        for (int column = 0; column < noOfColumns; ++column)
+            values.push_back(row.at(column));
+
+        this->setResults(values);
+        return true;
+    });
+}
+
+// rows are handed over one by one as they are fetched (no copy of result is kept);
+// handler returns false to stop fetching
+bool Query::processSelectQuery(const std::function<bool(const QueryRow &)> & rowHandler) {
+
+    this->_rowsProcessed = 0;
 
-        bool recordRetrieved = this->_query.first();
-        if (!recordRetrieved)
-            return true; // OK but empty
+    QElapsedTimer timer;
+    timer.start();
 
-        // table rows
-        while (recordRetrieved) {
+    const bool queryExecuted = this->_query.exec();
+    this->_boundBytes = 0;
 
-            // table columns
-            QVector<QVariant> values;
+    if (queryExecuted) {
 
-            for (int column = 0; column < _query.record().count(); ++column)
-                if (this->_query.value(column).isValid())
-                    values.push_back(this->_query.value(column));
+        QueryStatistics::record(this->_resourcePath, this->_connectionName, EXECUTE, timer.restart());
+        const QueryRow currentRow(this->_query);
 
-            this->setResults(values);
-            recordRetrieved = this->_query.next();
+        while (this->_query.next()) {
+
+            ++(this->_rowsProcessed);
+            if (!rowHandler(currentRow))
+                break;
         }
+        this->_query.finish();
+        QueryStatistics::record(this->_resourcePath, this->_connectionName, FETCH, timer.nsecsElapsed(),
+                                this->_rowsProcessed, currentRow.bytes());
     }
     else {
 
@@ -80,7 +188,15 @@ bool Query::processSelectQuery() {
 
 bool Query::processModifyQuery() {
 
-    if (!this->_query.exec()) {
+    QElapsedTimer timer;
+    timer.start();
+
+    const bool queryExecuted = this->_query.exec();
+    QueryStatistics::record(this->_resourcePath, this->_connectionName, EXECUTE, timer.nsecsElapsed(),
+                            (queryExecuted ? qMax(0, this->_query.numRowsAffected()) : 0), this->_boundBytes);
+    this->_boundBytes = 0;
+
+    if (!queryExecuted) {
 
         if (this->_query.lastError().isValid())
             ErrorMessage::critical(_query.lastError().text());
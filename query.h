@@ -6,6 +6,7 @@
 #ifndef QUERY_H
 #define QUERY_H
 
+#include <functional>
 #include <QPair>
 #include <QSqlDatabase>
 #include <QSqlQuery>
@@ -13,31 +14,77 @@
 #include <QVariant>
 #include <QVector>
 #include "database.h"
+#include "rowmapping.h"
 
 class Query {
 
     public:
         Query(const QSqlDatabase * db, const QVector<QPair<QString, QString>> & customBindings
               = QVector<QPair<QString, QString>>()):
-              _customBindings(customBindings), _query(QSqlQuery(*db)) {}
-        ~Query() {}
+              _customBindings(customBindings), _rowsProcessed(0), _boundBytes(0), _cached(true),
+              _statementCheckedOut(false), _statementGeneration(0), _connectionName(db->connectionName()),
+              _query(QSqlQuery(*db)) {}
+        ~Query();
 
         inline int noOfRowsInResults() const { return _results.size(); }
+        inline int noOfRowsProcessed() const { return _rowsProcessed; }
+        inline int noOfRowsAffected() const { return _query.numRowsAffected(); }
         QVector<QVariant> rowFromResults(int row) const { return _results.at(row); }
         void setResults(const QVector<QVariant> & newRow) { _results.push_back(newRow); return; }
 
         bool prepareQuery(const QString &);
+        bool prepareBatchQuery(const QString &, const int);
         void setAllBindingsForProps(const DatabaseConnectionProps * const);
         inline void setBinding(const QString & placeholder, const QString & value)
-            { this->_query.bindValue(placeholder, value); return; };
+            { this->_boundBytes += 2 * value.size(); this->_query.bindValue(placeholder, value); return; };
+        inline void setBinding(const int position, const QVariant & value)
+            { this->_boundBytes += QueryStatistics::sizeOfValue(value);
+              this->_query.bindValue(position, value); return; };
+        // SQL fragment (e.g. compiled filter) replacing placeholder verbatim, must be set before query is prepared
+        inline void setClause(const QString & placeholder, const QString & clause)
+            { this->_clauses.push_back(qMakePair(placeholder, clause)); return; }
+        // must be set before query is prepared
+        inline void setForwardOnly(const bool forwardOnly)
+            { this->_query.setForwardOnly(forwardOnly); return; }
+        // statement used only once (e.g. batch of odd size) is not kept in StatementCache,
+        // must be set before query is prepared
+        inline void setCached(const bool cached) { this->_cached = cached; return; }
         bool processSelectQuery();
+        bool processSelectQuery(const std::function<bool(const QueryRow &)> &);
+        // rows decoded by mapping (rowmapping.h) straight into one reused Row
+        template<typename Row, typename... Types, typename Handler>
+        bool processSelectQuery(const RowMapping<Row, Types...> & mapping, const Handler & rowHandler) {
+            Row decodedRow;
+            return this->processSelectQuery([&mapping, &rowHandler, &decodedRow](const QueryRow & row) -> bool
+                { mapping.decode(row, decodedRow); return rowHandler(static_cast<const Row &>(decodedRow)); });
+        }
+        // true if query was processed and returned at least one row (only first row is decoded)
+        template<typename Row, typename... Types>
+        bool selectFirstRow(const RowMapping<Row, Types...> & mapping, Row & firstRow) {
+            bool rowFound = false;
+            return (this->processSelectQuery([&mapping, &firstRow, &rowFound](const QueryRow & row) -> bool
+                { mapping.decode(row, firstRow); rowFound = true; return false; }) && rowFound);
+        }
         bool processModifyQuery();
+        // SQL resource with custom bindings applied (without preparing statement)
+        bool loadQueryString(const QString &);
+        inline QString queryString() const { return _queryString; }
 
     private:
-        void setCustomBinding(const QString &, const QString &);
+        QString customBindingValue(const QString &) const;
+        bool prepareStatement();
+        void releaseStatement();
 
         QVector<QPair<QString, QString>> _customBindings;
+        QVector<QPair<QString, QString>> _clauses;
         QVector<QVector<QVariant>> _results;
+        int _rowsProcessed;
+        qint64 _boundBytes; // since last execution
+        bool _cached;
+        bool _statementCheckedOut;
+        int _statementGeneration; // of connection in StatementCache when statement was checked out
+        const QString _connectionName;
+        QString _resourcePath;
         QString _queryString;
         QSqlQuery _query;
 };
@@ -0,0 +1,195 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QStringList>
+#include "constants.h"
+#include "querystatistics.h"
+
+QMutex QueryStatistics::_mutex;
+QHash<QString, QueryMeasurements> QueryStatistics::_measurements;
+
+LatencyHistogram::LatencyHistogram():
+    _buckets(QVector<qint64>(noOfBuckets, 0)), _count(0), _total(0), _maximum(0) {}
+
+int LatencyHistogram::bucket(const qint64 elapsed) {
+
+    if (elapsed <= 1)
+        return 0;
+
+    return qMin(noOfBuckets - 1, int(4 * std::log2(double(elapsed))));
+}
+
+void LatencyHistogram::record(const qint64 elapsed) {
+
+    ++(this->_buckets[bucket(elapsed)]);
+    ++(this->_count);
+    this->_total += elapsed;
+    this->_maximum = qMax(this->_maximum, elapsed);
+    return;
+}
+
+qint64 LatencyHistogram::percentile(const double fraction) const {
+
+    if (this->_count == 0)
+        return 0;
+
+    const qint64 rank = qMax(qint64(1), qint64(std::ceil(fraction * this->_count)));
+    qint64 countBelow = 0;
+
+    for (int i = 0; i < noOfBuckets; ++i) {
+
+        countBelow += this->_buckets.at(i);
+        if (countBelow >= rank)
+            return qMin(this->_maximum, qint64(std::pow(2.0, (i + 1) / 4.0)));
+    }
+    return this->_maximum;
+}
+
+void QueryStatistics::record(const QString & resource, const QString & connectionName,
+                             const queryPhase phase, const qint64 elapsed, const qint64 rows,
+                             const qint64 bytes) {
+
+    // clones of worker threads are counted under connection they were cloned from
+    // (threads of pool change with every harvest)
+    const int cloneSuffix = connectionName.indexOf(sql::threadConnectionSuffix);
+    const QString logicalConnectionName =
+        (cloneSuffix == -1) ? connectionName : connectionName.left(cloneSuffix);
+    const QString key = resource + QChar('|') + logicalConnectionName;
+
+    QMutexLocker locker(&_mutex);
+
+    auto measurements = _measurements.find(key);
+    if (measurements == _measurements.end()) {
+
+        QueryMeasurements newMeasurements;
+        newMeasurements._resource = resource;
+        newMeasurements._connectionName = logicalConnectionName;
+        measurements = _measurements.insert(key, newMeasurements);
+    }
+
+    switch (phase) {
+        case PREPARE: measurements.value()._prepare.record(elapsed); break;
+        case EXECUTE: measurements.value()._execute.record(elapsed); break;
+        case FETCH: measurements.value()._fetch.record(elapsed); break;
+    }
+    measurements.value()._rows += rows;
+    measurements.value()._bytes += bytes;
+    return;
+}
+
+// most expensive queries (by total time) first
+QVector<QueryMeasurements> QueryStatistics::snapshot() {
+
+    QVector<QueryMeasurements> measurements;
+    {
+        QMutexLocker locker(&_mutex);
+        measurements.reserve(_measurements.size());
+        for (auto it = _measurements.cbegin(); it != _measurements.cend(); ++it)
+            measurements.push_back(it.value());
+    }
+
+    std::sort(measurements.begin(), measurements.end(),
+              [](const QueryMeasurements & lhs, const QueryMeasurements & rhs) -> bool {
+                  return (lhs._prepare.total() + lhs._execute.total() + lhs._fetch.total() >
+                          rhs._prepare.total() + rhs._execute.total() + rhs._fetch.total()); });
+
+    return measurements;
+}
+
+void QueryStatistics::reset() {
+
+    QMutexLocker locker(&_mutex);
+    _measurements.clear();
+    return;
+}
+
+static QJsonObject histogramToJson(const LatencyHistogram & histogram) {
+
+    QJsonObject result;
+    result.insert(QStringLiteral("count"), histogram.count());
+    result.insert(QStringLiteral("totalUs"), histogram.total() / 1000);
+    result.insert(QStringLiteral("p50Us"), histogram.percentile(0.50) / 1000);
+    result.insert(QStringLiteral("p95Us"), histogram.percentile(0.95) / 1000);
+    result.insert(QStringLiteral("p99Us"), histogram.percentile(0.99) / 1000);
+    result.insert(QStringLiteral("maxUs"), histogram.maximum() / 1000);
+    return result;
+}
+
+QJsonArray QueryStatistics::toJson() {
+
+    QJsonArray result;
+    for (auto it: snapshot()) {
+
+        QJsonObject query;
+        query.insert(QStringLiteral("resource"), it._resource);
+        query.insert(QStringLiteral("connection"), it._connectionName);
+        query.insert(QStringLiteral("prepare"), histogramToJson(it._prepare));
+        query.insert(QStringLiteral("execute"), histogramToJson(it._execute));
+        query.insert(QStringLiteral("fetch"), histogramToJson(it._fetch));
+        query.insert(QStringLiteral("rows"), it._rows);
+        query.insert(QStringLiteral("bytes"), it._bytes);
+        result.append(query);
+    }
+    return result;
+}
+
+static QString milliseconds(const qint64 elapsed) {
+
+    return QString::number(elapsed / 1000000.0, 'f', 2);
+}
+
+static QString resourceName(const QString & resource) {
+
+    return resource.mid(resource.lastIndexOf(QChar('/')) + 1);
+}
+
+// one row per query: counts, p50/p95/p99 [ms] of execute and fetch phases, rows and bytes
+QString QueryStatistics::report() {
+
+    QStringList lines { QStringLiteral("%1 %2 %3 %4 %5 %6 %7")
+        .arg(QStringLiteral("dotaz"), -40).arg(QStringLiteral("spojení"), -30)
+        .arg(QStringLiteral("počet"), 8).arg(QStringLiteral("provedení p50/p95/p99 [ms]"), 30)
+        .arg(QStringLiteral("čtení p50/p95/p99 [ms]"), 30).arg(QStringLiteral("řádky"), 10)
+        .arg(QStringLiteral("bajty"), 12) };
+
+    for (auto it: snapshot()) {
+
+        const qint64 count = qMax(it._prepare.count(), it._execute.count());
+        lines << QStringLiteral("%1 %2 %3 %4 %5 %6 %7")
+            .arg(resourceName(it._resource), -40).arg(it._connectionName, -30).arg(count, 8)
+            .arg(QStringList({ milliseconds(it._execute.percentile(0.50)),
+                               milliseconds(it._execute.percentile(0.95)),
+                               milliseconds(it._execute.percentile(0.99)) }).join(QChar('/')), 30)
+            .arg(QStringList({ milliseconds(it._fetch.percentile(0.50)),
+                               milliseconds(it._fetch.percentile(0.95)),
+                               milliseconds(it._fetch.percentile(0.99)) }).join(QChar('/')), 30)
+            .arg(it._rows, 10).arg(it._bytes, 12);
+    }
+    return lines.join(QChar('\n'));
+}
+
+// five most expensive queries on one line (periodic log of headless mode)
+QString QueryStatistics::summaryLine() {
+
+    const int noOfQueries = 5;
+    const QVector<QueryMeasurements> measurements = snapshot();
+    QStringList queries;
+
+    for (int i = 0; i < qMin(noOfQueries, measurements.size()); ++i) {
+
+        const QueryMeasurements & it = measurements.at(i);
+        queries << QStringLiteral("%1@%2 n=%3 exec p50/p99=%4/%5ms fetch p50/p99=%6/%7ms rows=%8 bytes=%9")
+            .arg(resourceName(it._resource), it._connectionName)
+            .arg(it._execute.count())
+            .arg(milliseconds(it._execute.percentile(0.50)), milliseconds(it._execute.percentile(0.99)),
+                 milliseconds(it._fetch.percentile(0.50)), milliseconds(it._fetch.percentile(0.99)))
+            .arg(it._rows).arg(it._bytes);
+    }
+    return (QStringLiteral("query statistics: ") + queries.join(QStringLiteral("; ")));
+}
@@ -0,0 +1,83 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef QUERYSTATISTICS_H
+#define QUERYSTATISTICS_H
+
+#include <QHash>
+#include <QJsonArray>
+#include <QMutex>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+// latency histogram with logarithmic buckets (4 buckets per power of two, 1 ns .. ~18 min),
+// percentiles are reported as upper bound of bucket (relative error < 19 %)
+class LatencyHistogram {
+
+    public:
+        LatencyHistogram();
+        ~LatencyHistogram() {}
+
+        void record(const qint64);
+        qint64 percentile(const double) const; // [ns]
+
+        inline qint64 count() const { return _count; }
+        inline qint64 total() const { return _total; }
+        inline qint64 maximum() const { return _maximum; }
+
+    private:
+        static const int noOfBuckets = 160;
+        static int bucket(const qint64);
+
+        QVector<qint64> _buckets;
+        qint64 _count;
+        qint64 _total; // [ns]
+        qint64 _maximum; // [ns]
+};
+
+// phases of query which are measured separately: prepare (incl. resource loading),
+// execute (until first row is available / statement is done) and fetch (row loop incl. handler)
+enum queryPhase { PREPARE, EXECUTE, FETCH };
+
+struct QueryMeasurements {
+
+    QString _resource;
+    QString _connectionName;
+    LatencyHistogram _prepare;
+    LatencyHistogram _execute;
+    LatencyHistogram _fetch;
+    qint64 _rows = 0; // fetched (select) or affected (insert/update/delete)
+    qint64 _bytes = 0; // fetched (select) or bound (insert/update/delete)
+};
+
+// measurements of all queries run through Query, tagged by SQL resource and connection name
+class QueryStatistics {
+
+    public:
+        static void record(const QString &, const QString &, const queryPhase, const qint64,
+                           const qint64 = 0, const qint64 = 0);
+        static QVector<QueryMeasurements> snapshot();
+        static void reset();
+
+        static QJsonArray toJson();
+        static QString report();
+        static QString summaryLine();
+
+        // approximate size of value as transferred by driver
+        static inline qint64 sizeOfValue(const QVariant & value) {
+            switch (value.type()) {
+                case QVariant::String: return (2 * value.toString().size());
+                case QVariant::ByteArray: return value.toByteArray().size();
+                default: return (value.isNull() ? 0 : 8);
+            }
+        }
+
+    private:
+        static QMutex _mutex;
+        static QHash<QString, QueryMeasurements> _measurements;
+};
+
+#endif // QUERYSTATISTICS_H
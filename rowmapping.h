@@ -0,0 +1,136 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef ROWMAPPING_H
+#define ROWMAPPING_H
+
+#include <cstddef>
+#include <tuple>
+#include <type_traits>
+#include <QDateTime>
+#include <QSqlQuery>
+#include <QSqlRecord>
+#include <QString>
+#include <QUuid>
+#include <QVariant>
+#include "lsn.h"
+#include "querystatistics.h"
+
+// current row of forward-only result (valid only inside row handler)
+class QueryRow {
+
+    public:
+        explicit QueryRow(const QSqlQuery & query): _query(query), _bytes(0) {}
+        ~QueryRow() {}
+
+        inline QVariant at(const int column) const
+            { const QVariant value = _query.value(column);
+              _bytes += QueryStatistics::sizeOfValue(value); return value; }
+        inline bool isNull(const int column) const { return _query.isNull(column); }
+        inline int noOfColumns() const { return _query.record().count(); }
+        // size of values read by handler so far
+        inline qint64 bytes() const { return _bytes; }
+
+    private:
+        const QSqlQuery & _query;
+        mutable qint64 _bytes;
+};
+
+// member which distinguishes NULL from default value
+template<typename T>
+struct Nullable {
+
+    bool _isNull = true;
+    T _value = T();
+};
+
+// type of columns which are not decoded (see skipColumn)
+struct SkippedColumn {};
+
+// typed extraction of one cell (cell is read once; NULL => default value)
+template<typename T>
+struct ColumnDecoder {
+
+    static inline void decode(const QVariant & cell, T & value)
+        { value = (cell.isNull() ? T() : cell.value<T>()); }
+};
+
+template<>
+struct ColumnDecoder<LSN> {
+
+    static inline void decode(const QVariant & cell, LSN & value) { value = LSN::fromVariant(cell); }
+};
+
+// fn_dblog returns times as text (yyyy/MM/dd HH:mm:ss:zzz)
+template<>
+struct ColumnDecoder<QDateTime> {
+
+    static inline void decode(const QVariant & cell, QDateTime & value) {
+        if (cell.type() != QVariant::String) {
+            value = cell.toDateTime();
+            return;
+        }
+        value = QDateTime::fromString(cell.toString(), QStringLiteral("yyyy/MM/dd HH:mm:ss:zzz"));
+        if (!value.isValid())
+            value = QDateTime::fromString(cell.toString(), Qt::ISODateWithMs);
+    }
+};
+
+template<>
+struct ColumnDecoder<SkippedColumn> {
+
+    static inline void decode(const QVariant &, SkippedColumn &) {}
+};
+
+template<typename T>
+struct ColumnDecoder<Nullable<T>> {
+
+    static inline void decode(const QVariant & cell, Nullable<T> & value)
+        { value._isNull = cell.isNull(); ColumnDecoder<T>::decode(cell, value._value); }
+};
+
+// result columns (in order of select list) mapped onto members of Row, e.g.
+// mapColumns(&Row::_ID, &Row::_name) decodes column 0 into _ID and column 1 into _name;
+// column is skipped (not read at all) by skipColumn<Row>()
+template<typename Row, typename... Types>
+class RowMapping {
+
+    public:
+        explicit RowMapping(Types Row::*... members): _members(members...) {}
+        ~RowMapping() {}
+
+        inline void decode(const QueryRow & row, Row & target) const { this->decodeColumn<0>(row, target); }
+
+    private:
+        template<std::size_t Column>
+        inline typename std::enable_if<(Column == sizeof...(Types))>::type
+            decodeColumn(const QueryRow &, Row &) const {}
+
+        template<std::size_t Column>
+        inline typename std::enable_if<(Column < sizeof...(Types))>::type
+            decodeColumn(const QueryRow & row, Row & target) const {
+
+            typedef typename std::tuple_element<Column, std::tuple<Types...>>::type ColumnType;
+            if (std::get<Column>(_members) != nullptr)
+                ColumnDecoder<ColumnType>::decode(row.at(int(Column)), target.*std::get<Column>(_members));
+            this->decodeColumn<Column + 1>(row, target);
+        }
+
+        const std::tuple<Types Row::*...> _members;
+};
+
+template<typename Row, typename... Types>
+inline RowMapping<Row, Types...> mapColumns(Types Row::*... members) {
+
+    return RowMapping<Row, Types...>(members...);
+}
+
+template<typename Row>
+inline SkippedColumn Row::* skipColumn() {
+
+    return nullptr;
+}
+
+#endif // ROWMAPPING_H
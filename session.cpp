@@ -3,17 +3,71 @@
  This program is distributed under the terms of the GNU General Public License.
 *******************************************************************************/
 
+#include <QMutex>
 #include <QSqlError>
+#include <QThreadPool>
 #include "query.h"
 #include "session.h"
 #include "shared.h"
 
-Session::Session(): _systemDatabase(new Database) {
+// row of list of tracked databases (columns in order of select list)
+struct TrackedDatabaseRow {
+
+    QUuid _ID;
+    QString _serverName;
+    QString _portNo;
+    int _databaseID = -1;
+    QString _dbName;
+    QString _userName;
+};
+
+// row of list of log filters
+struct LogFilterRow {
+
+    QUuid _databaseID;
+    QString _filterType;
+    QString _pattern;
+    bool _excluded = false;
+};
+
+struct RetentionPolicyRow {
+
+    QUuid _databaseID;
+    int _keepDays = 0;
+    bool _hourlyRollup = true;
+};
+
+Session::Session():
+    _systemDatabase(new Database), _harvestConcurrency(sql::defaultHarvestConcurrency),
+    _trackingStorage(TrackingStorage::instance(TrackingStorage::TABLE_PER_DATABASE)) {
 
      if (this->connectToSystemDatabase()) {
 
+        if (!Database::createWatermarkTable(this->systemDatabase()->dbConnection()))
+            ErrorMessage::warning(QStringLiteral("Nepodařilo se vytvořit tabulku značek sklizně."));
+
+        if (!Database::createLogFilterTable(this->systemDatabase()->dbConnection()))
+            ErrorMessage::warning(QStringLiteral("Nepodařilo se vytvořit tabulku filtrů logu."));
+
+        if (!Database::createLogBackupTable(this->systemDatabase()->dbConnection()))
+            ErrorMessage::warning(QStringLiteral("Nepodařilo se vytvořit tabulku záloh logu."));
+
+        if (!Database::createRetentionTables(this->systemDatabase()->dbConnection()))
+            ErrorMessage::warning(QStringLiteral("Nepodařilo se vytvořit tabulky pravidel uchování záznamů."));
+
+        this->_trackingStorage = TrackingStorage::instance(
+            TrackingStorage::detectMode(this->systemDatabase()->dbConnection()));
+
         if (!this->loadDatabases())
             this->_currentUserDatabaseID = QUuid();
+        else {
+
+            if (!this->loadLogFilters())
+                ErrorMessage::warning(QStringLiteral("Nepodařilo se načíst filtry logu, log bude čten celý."));
+
+            if (!this->loadRetentionPolicies())
+                ErrorMessage::warning(QStringLiteral("Nepodařilo se načíst pravidla uchování záznamů, záznamy nebudou mazány."));
+        }
      }
      else
          ErrorMessage::critical(QStringLiteral("Nepodařilo se připojit k systémové databázi."));
@@ -43,6 +97,7 @@ QUuid Session::addNewUserDatabase() {
 
     Database * const newDB = new Database(ID, int(-1), connectionName,
                                           DatabaseConnectionProps(sql::defaultPortNo));
+    newDB->setTrackingStorage(this->_trackingStorage);
     this->_db.push_back(newDB);
 
     return ID;
@@ -62,6 +117,11 @@ bool Session::removeUserDatabase(QUuid & currentIDAfterRemove) {
 
                 if ((*it)->ID() == _currentUserDatabaseID) {
 
+                    // rows in shared table are purged by short batches first (already purged rows
+                    // stay purged if removal fails)
+                    if (!(*it)->purgeLogTableOfThisDB(this->systemDatabase()->dbConnection()))
+                        break;
+
                     QSqlDatabase::database(this->systemDatabase()->connectionName()).transaction();
                     // drop (this DB's) log table
                     // log table must be dropped before removing tracking record (key constraint)
@@ -168,6 +228,13 @@ bool Session::saveUserDbConfiguration() {
 
     bool configurationSaved = false;
 
+    // connection may have been verified by worker thread only => open it here too
+    if (!this->db(_currentUserDatabaseID)->openConnection()) {
+
+        ErrorMessage::critical(QStringLiteral("Konfiguraci se nepodařilo uložit."));
+        return false;
+    }
+
     if (this->isUserDbNew()) {
 
         Database * const newDatabase = this->db(_currentUserDatabaseID);
@@ -225,20 +292,54 @@ bool Session::loadRecordsFromLog() {
     Database * const currentDatabase = this->db(_currentUserDatabaseID);
 
     // retrieve last tracked LSN
-    const QString lastLSN = currentDatabase->retrieveLastLSNFromTrackingTable();
+    const LSN lastLSN =
+        currentDatabase->retrieveLastLSNFromTrackingTable(this->systemDatabase()->dbConnection());
 
-    // load data from log
-    const bool logDataLoaded = currentDatabase->loadAllLogRecordsFromGivenLSN(lastLSN);
+    // load data from log (and from log backups if log was truncated since last harvest)
+    const bool logDataLoaded =
+        currentDatabase->planLogBackups(currentDatabase->dbConnection(),
+                                        this->systemDatabase()->dbConnection(), lastLSN) &&
+        currentDatabase->loadAllLogRecordsFromGivenLSN(lastLSN);
 
     // update tracking table with log data
     if (logDataLoaded) {
 
-        currentDatabase->updateTrackingTableWithLogData(this->systemDatabase()->dbConnection());
+        if (currentDatabase->updateTrackingTableWithLogData(this->systemDatabase()->dbConnection()))
+            currentDatabase->storeCapturedImages(this->systemDatabase()->dbConnection(), lastLSN);
     }
 
     return logDataLoaded;
 }
 
+// all tracked databases are harvested in parallel (at most _harvestConcurrency at the same time)
+bool Session::loadRecordsFromAllLogs(QVector<HarvestResult> & results) {
+
+    QThreadPool harvestPool;
+    harvestPool.setMaxThreadCount(this->_harvestConcurrency);
+    QMutex resultsMutex;
+
+    for (auto it: this->_db) {
+
+        // database is not saved yet
+        if (it->databaseID() == -1)
+            continue;
+
+        // workers clone this connection => it only needs to be configured here
+        if (!it->connectionEstablished())
+            it->setConnectionString(it->connectionProperties());
+
+        harvestPool.start(new HarvestTask(it, this->systemDatabase()->connectionName(),
+                                          &results, &resultsMutex));
+    }
+    harvestPool.waitForDone();
+
+    bool allHarvested = true;
+    for (auto it: results)
+        allHarvested = allHarvested && it._success;
+
+    return allHarvested;
+}
+
 bool Session::retrieveUserDbSettings(QMap<Database::dbSettings, QString> & dbSettings) const {
 
     return (this->db(this->_currentUserDatabaseID)->retrieveSettings(dbSettings));
@@ -253,39 +354,131 @@ bool Session::loadDatabases() {
     if (!queryToExecute->prepareQuery(resourceForQuery))
         return false;
 
-    const bool queryProcessed = queryToExecute->processSelectQuery();
-
-    if (queryProcessed) {
+    const auto trackedDatabaseMapping = mapColumns(&TrackedDatabaseRow::_ID, &TrackedDatabaseRow::_serverName,
+        &TrackedDatabaseRow::_portNo, &TrackedDatabaseRow::_databaseID, &TrackedDatabaseRow::_dbName,
+        &TrackedDatabaseRow::_userName);
 
-        const int noOfRecords = queryToExecute->noOfRowsInResults();
-        if (noOfRecords < 1)
-            return false;
-
-        for (int i = 0; i < noOfRecords; ++i) {
+    const bool queryProcessed = queryToExecute->processSelectQuery(trackedDatabaseMapping,
+        [this](const TrackedDatabaseRow & trackedDB) -> bool {
 
             const QString connectionName =
-                QStringLiteral("connection_") + queryToExecute->rowFromResults(i).at(0).toString();
-
-            const QUuid ID = queryToExecute->rowFromResults(i).at(0).toUuid();
-            const int dbID = queryToExecute->rowFromResults(i).at(3).toInt();
+                QStringLiteral("connection_") + trackedDB._ID.toString(QUuid::WithoutBraces);
 
             const DatabaseConnectionProps properties = DatabaseConnectionProps(
-                queryToExecute->rowFromResults(i).at(1).toString(), // serverName
-                queryToExecute->rowFromResults(i).at(2).toString(), // port
-                queryToExecute->rowFromResults(i).at(4).toString(), // dbName
-                queryToExecute->rowFromResults(i).at(5).toString()); // userName
+                trackedDB._serverName, trackedDB._portNo, trackedDB._dbName, trackedDB._userName);
 
-            Database * const userDB = new Database(ID, dbID, connectionName, properties);
+            Database * const userDB = new Database(trackedDB._ID, trackedDB._databaseID, connectionName, properties);
+            userDB->setTrackingStorage(this->_trackingStorage);
             this->_db.push_back(userDB);
 
             // first database is set as current
-            if (i == 0)
-                this->_currentUserDatabaseID = ID;
-        }
-    }
-    else
+            if (this->_db.size() == 1)
+                this->_currentUserDatabaseID = trackedDB._ID;
+
+            return true;
+        });
+
+    if (!queryProcessed)
         ErrorMessage::warning(QStringLiteral("Nepodařilo se načíst údaje o sledovaných databázích."));
 
+    delete queryToExecute;
+    return (queryProcessed && !this->_db.isEmpty());
+}
+
+// rows harvested before are moved from own tables of databases, harvest continues from watermark
+// into shared table
+bool Session::useSharedTrackingTable() {
+
+    QVector<QUuid> IDs;
+    for (auto it: this->_db)
+        IDs << it->ID();
+
+    if (!TrackingStorage::createSharedTable(this->systemDatabase()->dbConnection(), IDs))
+        return false;
+
+    this->_trackingStorage = TrackingStorage::instance(TrackingStorage::SHARED_TABLE);
+    for (auto it: this->_db)
+        it->setTrackingStorage(this->_trackingStorage);
+
+    return true;
+}
+
+// tracking tables of older layout are only found here (rebuild is started by caller on request)
+bool Session::logTablesToMigrate(QVector<Database *> & databases) const {
+
+    bool layoutsLoaded = true;
+    for (auto it: this->_db) {
+
+        bool needsMigration = false;
+        layoutsLoaded = it->logTableNeedsMigration(this->systemDatabase()->dbConnection(), needsMigration) &&
+                        layoutsLoaded;
+        if (needsMigration)
+            databases << it;
+    }
+    return layoutsLoaded;
+}
+
+// filters of databases which are not tracked any more are removed with them (cascade)
+bool Session::loadLogFilters() {
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/list_of_log_filters.sql");
+
+    Query * const queryToExecute = new Query(this->systemDatabase()->dbConnection());
+
+    if (!queryToExecute->prepareQuery(resourceForQuery)) {
+
+        delete queryToExecute;
+        return false;
+    }
+
+    const auto logFilterMapping = mapColumns(&LogFilterRow::_databaseID, &LogFilterRow::_filterType,
+        &LogFilterRow::_pattern, &LogFilterRow::_excluded);
+
+    const bool queryProcessed = queryToExecute->processSelectQuery(logFilterMapping,
+        [this](const LogFilterRow & logFilter) -> bool {
+
+            Database * const userDB = this->db(logFilter._databaseID);
+            LogFilter::filterType type;
+
+            // unknown types are rejected by check constraint, row is skipped anyway
+            if (userDB != nullptr && LogFilter::typeFromName(logFilter._filterType, type))
+                userDB->logFilter().add(type, logFilter._pattern, logFilter._excluded);
+
+            return true;
+        });
+
+    delete queryToExecute;
+    return queryProcessed;
+}
+
+// databases without policy keep all rows
+bool Session::loadRetentionPolicies() {
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/list_of_retention_policies.sql");
+
+    Query * const queryToExecute = new Query(this->systemDatabase()->dbConnection());
+
+    if (!queryToExecute->prepareQuery(resourceForQuery)) {
+
+        delete queryToExecute;
+        return false;
+    }
+
+    const auto retentionPolicyMapping = mapColumns(&RetentionPolicyRow::_databaseID,
+        &RetentionPolicyRow::_keepDays, &RetentionPolicyRow::_hourlyRollup);
+
+    const bool queryProcessed = queryToExecute->processSelectQuery(retentionPolicyMapping,
+        [this](const RetentionPolicyRow & retentionPolicy) -> bool {
+
+            Database * const userDB = this->db(retentionPolicy._databaseID);
+            if (userDB != nullptr) {
+
+                userDB->retentionPolicy()._keepDays = retentionPolicy._keepDays;
+                userDB->retentionPolicy()._hourlyRollup = retentionPolicy._hourlyRollup;
+            }
+            return true;
+        });
+
     delete queryToExecute;
     return queryProcessed;
 }
@@ -7,7 +7,9 @@
 #define SESSION_H
 
 #include <QMap>
+#include <QVector>
 #include "database.h"
+#include "harvest.h"
 
 class Session {
 
@@ -30,14 +32,26 @@ class Session {
         bool connectToUserDatabase() const;
         bool saveUserDbConfiguration();
         bool loadRecordsFromLog();
+        bool loadRecordsFromAllLogs(QVector<HarvestResult> &);
+        inline int harvestConcurrency() const { return _harvestConcurrency; }
+        inline void setHarvestConcurrency(const int concurrency)
+            { _harvestConcurrency = (concurrency > 0) ? concurrency : sql::defaultHarvestConcurrency; return; }
         bool retrieveUserDbSettings(QMap<Database::dbSettings, QString> &) const;
+        // shared table is created (if needed) and used for all databases from now on
+        bool useSharedTrackingTable();
+        // databases whose tracking tables have older layout
+        bool logTablesToMigrate(QVector<Database *> &) const;
 
     private:
         bool loadDatabases();
+        bool loadLogFilters();
+        bool loadRetentionPolicies();
 
         Database * _systemDatabase;
         QUuid _currentUserDatabaseID;
         QVector<Database *> _db;
+        int _harvestConcurrency;
+        const TrackingStorage * _trackingStorage;
 };
 
 #endif // SESSION_H
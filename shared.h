@@ -6,8 +6,12 @@
 #ifndef SHARED_H
 #define SHARED_H
 
+#include <QApplication>
+#include <QCoreApplication>
+#include <QDebug>
 #include <QMessageBox>
 #include <QString>
+#include <QThread>
 #include "constants.h"
 
 class Brackets {
@@ -17,31 +21,49 @@ class Brackets {
             { return (shared::leftSqBr + text + shared::rightSqBr); }
 };
 
+// message boxes can be shown only from GUI thread of GUI application,
+// messages from worker threads (or in command-line mode) are logged
 class ErrorMessage {
 
     public:
         static void information(const QString & error) {
 
+            if (!canShowDialog()) { qInfo().noquote() << error; return; }
+
             QMessageBox::information(nullptr, QStringLiteral("Informace"), error);
             return;
         }
 
         static void warning(const QString & error) {
 
+            if (!canShowDialog()) { qWarning().noquote() << error; return; }
+
             QMessageBox::warning(nullptr, QStringLiteral("Upozornění"), error);
             return;
         }
 
         static void critical(const QString & error) {
 
+            if (!canShowDialog()) { qCritical().noquote() << error; return; }
+
             QMessageBox::critical(nullptr, QStringLiteral("Chyba"), error);
             return;
         }
 
         static QMessageBox::StandardButton question(const QString & question) {
 
+            if (!canShowDialog())
+                return QMessageBox::No;
+
             return (QMessageBox::question(nullptr, QStringLiteral("Dotaz"), question));
         }
+
+    private:
+        static bool canShowDialog() {
+
+            return (qobject_cast<QApplication *>(QCoreApplication::instance()) != nullptr &&
+                    QThread::currentThread() == QCoreApplication::instance()->thread());
+        }
 };
 
 #endif // SHARED_H
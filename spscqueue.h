@@ -0,0 +1,94 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <QAtomicInteger>
+#include <QThread>
+#include <QVector>
+
+// bounded lock-free queue between exactly one producer and one consumer thread (ring buffer,
+// capacity is rounded up to power of 2); push waits while queue is full (backpressure), pop waits
+// while it is empty. Producer closes queue when it is done, either side can abort it on error
+template<typename T>
+class SpscQueue {
+
+    public:
+        explicit SpscQueue(const int capacity): _mask(roundedCapacity(capacity) - 1),
+            _items(int(_mask) + 1), _head(0), _tail(0), _closed(0), _aborted(0) {}
+        ~SpscQueue() {}
+
+        inline int capacity() const { return _items.size(); }
+        inline bool isAborted() const { return (_aborted.loadAcquire() != 0); }
+        inline void close() { _closed.storeRelease(1); return; }
+        inline void abort() { _aborted.storeRelease(1); return; }
+
+        // false = consumer aborted queue (item was not enqueued)
+        bool push(const T & item) {
+
+            const quint32 tail = this->_tail.loadAcquire();
+            for (int attempt = 0; tail - this->_head.loadAcquire() > this->_mask; ++attempt) {
+
+                if (this->isAborted())
+                    return false;
+                wait(attempt);
+            }
+            this->_items[int(tail & this->_mask)] = item;
+            this->_tail.storeRelease(tail + 1);
+            return true;
+        }
+
+        // false = queue was closed and all items were taken (or queue was aborted)
+        bool pop(T & item) {
+
+            const quint32 head = this->_head.loadAcquire();
+            for (int attempt = 0; this->_tail.loadAcquire() == head; ++attempt) {
+
+                if (this->isAborted())
+                    return false;
+                // tail has to be checked again - item could be pushed just before queue was closed
+                if (this->_closed.loadAcquire() != 0 && this->_tail.loadAcquire() == head)
+                    return false;
+                wait(attempt);
+            }
+            if (this->isAborted())
+                return false;
+
+            T & slot = this->_items[int(head & this->_mask)];
+            item = slot;
+            slot = T(); // shared data (strings) is not kept alive by ring buffer
+            this->_head.storeRelease(head + 1);
+            return true;
+        }
+
+    private:
+        static quint32 roundedCapacity(const int capacity) {
+
+            quint32 rounded = 2;
+            while (rounded < quint32(capacity))
+                rounded <<= 1;
+            return rounded;
+        }
+
+        // short waits are spun, longer ones (other stage is stalled) sleep
+        static inline void wait(const int attempt) {
+
+            if (attempt < 64)
+                QThread::yieldCurrentThread();
+            else
+                QThread::usleep(200);
+            return;
+        }
+
+        const quint32 _mask;
+        QVector<T> _items;
+        alignas(64) QAtomicInteger<quint32> _head; // next item to pop (consumer)
+        alignas(64) QAtomicInteger<quint32> _tail; // next free slot (producer)
+        QAtomicInt _closed;
+        QAtomicInt _aborted;
+};
+
+#endif // SPSCQUEUE_H
@@ -0,0 +1,2 @@
+CREATE TABLE allocation_units
+  (allocation_unit_id bigint NOT NULL PRIMARY KEY, ObjectName nvarchar(256) NOT NULL);
@@ -0,0 +1,5 @@
+CREATE TABLE fn_dblog
+  ([Current LSN] char(22) NOT NULL PRIMARY KEY, AllocUnitId bigint NOT NULL,
+   Operation nvarchar(31) NOT NULL, [Transaction Name] nvarchar(33) NULL,
+   [Transaction ID] nvarchar(14) NOT NULL, [Begin Time] nvarchar(24) NULL,
+   [End Time] nvarchar(24) NULL, Description nvarchar(256) NULL, UserName nvarchar(128) NULL);
@@ -0,0 +1,3 @@
+CREATE TABLE IF NOT EXISTS HarvestWatermarks
+  (DatabaseID nvarchar(36) NOT NULL PRIMARY KEY, LastLSN binary(10) NOT NULL,
+   ScannedLSN binary(10) NULL, UpdatedAt datetime NOT NULL DEFAULT CURRENT_TIMESTAMP);
@@ -0,0 +1,5 @@
+CREATE TABLE :tableName
+  (ID integer PRIMARY KEY, DatabaseID nvarchar(36) NOT NULL, ObjectName nvarchar(256) NULL,
+   Operation nvarchar(60) NULL, TransactionID nvarchar(20) NOT NULL, BeginTime datetime NULL,
+   EndTime datetime NULL, UserName nvarchar(128) NULL, BeginLSN binary(10) NOT NULL,
+   EndLSN binary(10) NOT NULL);
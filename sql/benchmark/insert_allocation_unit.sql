@@ -0,0 +1 @@
+INSERT INTO allocation_units (allocation_unit_id, ObjectName) VALUES (?, ?);
@@ -0,0 +1,4 @@
+INSERT INTO fn_dblog
+  ([Current LSN], AllocUnitId, Operation, [Transaction Name], [Transaction ID], [Begin Time],
+   [End Time], Description, UserName)
+  VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);
@@ -0,0 +1,3 @@
+SELECT allocation_unit_id, ObjectName
+  FROM allocation_units
+  WHERE allocation_unit_id = ?;
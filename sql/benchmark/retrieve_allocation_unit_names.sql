@@ -0,0 +1,2 @@
+SELECT allocation_unit_id, ObjectName
+  FROM allocation_units;
@@ -0,0 +1,5 @@
+SELECT AllocUnitId, Operation, [Transaction Name], [Transaction ID], [Begin Time], [End Time],
+       UserName, [Current LSN]:imageColumns
+  FROM fn_dblog AS L
+  WHERE [Current LSN] >= COALESCE(SUBSTR(:fromLSN, 3), '') AND :logFilter
+  ORDER BY [Current LSN];
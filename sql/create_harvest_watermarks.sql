@@ -0,0 +1,8 @@
+IF OBJECT_ID(N'HarvestWatermarks', N'U') IS NULL
+  CREATE TABLE HarvestWatermarks
+    (DatabaseID uniqueidentifier NOT NULL PRIMARY KEY, LastLSN binary(10) NOT NULL,
+     ScannedLSN binary(10) NULL, UpdatedAt datetime NOT NULL DEFAULT CURRENT_TIMESTAMP,
+     CONSTRAINT FK_HarvestWatermarks_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID)
+     REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
+ELSE IF COL_LENGTH(N'HarvestWatermarks', N'ScannedLSN') IS NULL
+  ALTER TABLE HarvestWatermarks ADD ScannedLSN binary(10) NULL;
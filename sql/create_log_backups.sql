@@ -0,0 +1,7 @@
+IF OBJECT_ID(N'LogBackups', N'U') IS NULL
+  CREATE TABLE LogBackups
+    (DatabaseID uniqueidentifier NOT NULL, BackupSetID int NOT NULL, FirstLSN binary(10) NOT NULL,
+     LastLSN binary(10) NOT NULL, BackupFinished datetime NULL, FileName nvarchar(260) NOT NULL,
+     CONSTRAINT PK_LogBackups PRIMARY KEY (DatabaseID, BackupSetID),
+     CONSTRAINT FK_LogBackups_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID)
+     REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
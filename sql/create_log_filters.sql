@@ -0,0 +1,7 @@
+IF OBJECT_ID(N'LogFilters', N'U') IS NULL
+  CREATE TABLE LogFilters
+    (ID int IDENTITY(1, 1) PRIMARY KEY, DatabaseID uniqueidentifier NOT NULL,
+     FilterType nvarchar(20) NOT NULL, Pattern nvarchar(256) NOT NULL, Excluded bit NOT NULL DEFAULT 0,
+     CONSTRAINT CK_LogFilters_FilterType CHECK (FilterType IN (N'Operation', N'Context', N'Object', N'User')),
+     CONSTRAINT FK_LogFilters_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID)
+     REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
@@ -0,0 +1,8 @@
+IF OBJECT_ID(N':imageTableName', N'U') IS NULL
+  CREATE TABLE :imageTableName
+    (CurrentLSN binary(10) NOT NULL PRIMARY KEY, TransactionID nvarchar(20) NOT NULL,
+     AllocUnitId bigint NOT NULL, Operation nvarchar(60) NOT NULL,
+     RowLogContents0 varbinary(max) NULL, RowLogContents1 varbinary(max) NULL);
+
+IF COL_LENGTH(N':imageTableName', N'LogRecord') IS NULL
+  ALTER TABLE :imageTableName ADD LogRecord varbinary(max) NULL;
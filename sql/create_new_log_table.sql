@@ -0,0 +1,12 @@
+CREATE TABLE :tableName
+  (ID bigint IDENTITY(1, 1) NOT NULL, DatabaseID uniqueidentifier NOT NULL,
+   Create_Date datetime NOT NULL DEFAULT CURRENT_TIMESTAMP, ObjectName nvarchar(256) NULL,
+   Operation nvarchar(60) NULL, TransactionID nvarchar(20) NOT NULL, BeginTime datetime NULL,
+   EndTime datetime NULL, UserName nvarchar(128) NULL, BeginLSN binary(10) NOT NULL,
+   EndLSN binary(10) NOT NULL,
+   PRIMARY KEY CLUSTERED (EndLSN),
+   CONSTRAINT :foreignKeyName FOREIGN KEY (DatabaseID) REFERENCES TrackedDatabases(ID));
+
+CREATE INDEX IX_TransactionID ON :tableName (TransactionID) INCLUDE (BeginLSN);
+CREATE INDEX IX_EndTime ON :tableName (EndTime)
+  INCLUDE (ObjectName, Operation, TransactionID, BeginTime, UserName, BeginLSN);
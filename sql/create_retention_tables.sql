@@ -0,0 +1,13 @@
+IF OBJECT_ID(N'RetentionPolicies', N'U') IS NULL
+  CREATE TABLE RetentionPolicies
+    (DatabaseID uniqueidentifier NOT NULL PRIMARY KEY, KeepDays int NOT NULL CHECK (KeepDays > 0),
+     HourlyRollup bit NOT NULL DEFAULT 1,
+     CONSTRAINT FK_RetentionPolicies_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID)
+     REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
+IF OBJECT_ID(N'HourlyTransactionSummary', N'U') IS NULL
+  CREATE TABLE HourlyTransactionSummary
+    (DatabaseID uniqueidentifier NOT NULL, HourStart datetime NOT NULL, ObjectName nvarchar(256) NOT NULL,
+     NoOfTransactions int NOT NULL, LastLSN binary(10) NOT NULL,
+     CONSTRAINT PK_HourlyTransactionSummary PRIMARY KEY (DatabaseID, HourStart, ObjectName),
+     CONSTRAINT FK_HourlyTransactionSummary_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID)
+     REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
@@ -0,0 +1,16 @@
+IF OBJECT_ID(N':tableName', N'U') IS NULL
+BEGIN
+  CREATE TABLE :tableName
+    (ID bigint IDENTITY(1, 1) NOT NULL, DatabaseID uniqueidentifier NOT NULL,
+     Create_Date datetime NOT NULL DEFAULT CURRENT_TIMESTAMP, ObjectName nvarchar(256) NULL,
+     Operation nvarchar(60) NULL, TransactionID nvarchar(20) NOT NULL, BeginTime datetime NULL,
+     EndTime datetime NULL, UserName nvarchar(128) NULL, BeginLSN binary(10) NOT NULL,
+     EndLSN binary(10) NOT NULL,
+     CONSTRAINT PK_TrackedTransactions PRIMARY KEY CLUSTERED (DatabaseID, EndLSN),
+     CONSTRAINT FK_TrackedTransactions_DatabaseID_TrackedDatabases_ID FOREIGN KEY (DatabaseID)
+     REFERENCES TrackedDatabases(ID) ON DELETE CASCADE);
+
+  CREATE INDEX IX_TransactionID ON :tableName (DatabaseID, TransactionID) INCLUDE (BeginLSN);
+  CREATE INDEX IX_EndTime ON :tableName (EndTime)
+    INCLUDE (DatabaseID, ObjectName, Operation, TransactionID, BeginTime, UserName, BeginLSN);
+END
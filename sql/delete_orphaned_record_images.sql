@@ -0,0 +1,7 @@
+DELETE I
+  FROM :imageTableName AS I
+  WHERE I.CurrentLSN > ?
+    AND NOT EXISTS (SELECT 1
+                      FROM :tableName AS T
+                      WHERE T.EndLSN >= I.CurrentLSN AND T.BeginLSN <= I.CurrentLSN
+                        AND T.TransactionID = I.TransactionID AND :trackedRows);
@@ -0,0 +1,2 @@
+DELETE FROM :imageTableName
+  WHERE CurrentLSN > ?;
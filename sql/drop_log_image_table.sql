@@ -0,0 +1,2 @@
+IF OBJECT_ID(N':imageTableName', N'U') IS NOT NULL
+  DROP TABLE :imageTableName;
@@ -0,0 +1,2 @@
+IF OBJECT_ID(N':tableName', N'U') IS NOT NULL
+  DROP TABLE :tableName;
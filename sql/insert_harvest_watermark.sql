@@ -0,0 +1,2 @@
+INSERT INTO HarvestWatermarks (LastLSN, ScannedLSN, DatabaseID)
+  VALUES (?, ?, ?);
@@ -0,0 +1,3 @@
+INSERT INTO LogBackups
+  (DatabaseID, BackupSetID, FirstLSN, LastLSN, BackupFinished, FileName)
+  VALUES (?, ?, ?, ?, ?, ?);
@@ -0,0 +1,3 @@
+INSERT INTO :tableName
+  (DatabaseID, ObjectName, Operation, TransactionID, BeginTime, EndTime, UserName, BeginLSN, EndLSN)
+  VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?);
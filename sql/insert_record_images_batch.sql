@@ -0,0 +1,3 @@
+INSERT INTO :imageTableName
+  (CurrentLSN, TransactionID, AllocUnitId, Operation, RowLogContents0, RowLogContents1)
+  VALUES (?, ?, ?, ?, ?, ?);
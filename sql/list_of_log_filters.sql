@@ -0,0 +1,3 @@
+SELECT DatabaseID, FilterType, Pattern, Excluded
+  FROM LogFilters
+  ORDER BY DatabaseID, ID;
@@ -0,0 +1 @@
+SELECT DatabaseID, KeepDays, HourlyRollup FROM RetentionPolicies;
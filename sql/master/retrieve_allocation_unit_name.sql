@@ -0,0 +1,9 @@
+SELECT AU.allocation_unit_id, S.name + N'.' + O.name AS ObjectName
+  FROM :dbName.sys.system_internals_allocation_units AS AU
+  INNER JOIN :dbName.sys.partitions AS P
+  ON P.partition_id = AU.container_id
+  INNER JOIN :dbName.sys.objects AS O
+  ON P.object_id = O.object_id
+  INNER JOIN :dbName.sys.schemas AS S
+  ON O.schema_id = S.schema_id
+  WHERE AU.allocation_unit_id = ?;
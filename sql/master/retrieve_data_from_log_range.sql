@@ -0,0 +1,5 @@
+SELECT L.AllocUnitId, L.Operation, L.[Transaction Name], L.[Transaction ID], L.[Begin Time],
+       L.[End Time], SUSER_SNAME(L.[Transaction SID]) AS UserName, L.[Current LSN]:imageColumns
+  FROM fn_dblog(:fromLSN, :toLSN) AS L
+  WHERE :logFilter
+  ORDER BY L.[Current LSN];
@@ -0,0 +1,2 @@
+SELECT TOP (1) L.[Current LSN]
+  FROM fn_dblog(NULL, NULL) AS L;
@@ -0,0 +1,11 @@
+SELECT B.backup_set_id, CAST(B.first_lsn AS varchar(25)), CAST(B.last_lsn AS varchar(25)),
+       B.backup_finish_date, F.physical_device_name
+  FROM msdb.dbo.backupset AS B
+  INNER JOIN msdb.dbo.backupmediafamily AS F
+  ON F.media_set_id = B.media_set_id AND F.family_sequence_number = 1 AND F.mirror = 0
+  WHERE B.database_name = DB_NAME() AND B.type = 'L' AND B.backup_set_id > ?
+    AND F.device_type IN (2, 102)
+    AND NOT EXISTS (SELECT 1
+                      FROM msdb.dbo.backupmediafamily AS S
+                      WHERE S.media_set_id = B.media_set_id AND S.family_sequence_number > 1)
+  ORDER BY B.backup_set_id;
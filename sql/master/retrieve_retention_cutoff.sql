@@ -0,0 +1 @@
+SELECT DATEADD(day, -:keepDays, GETDATE());
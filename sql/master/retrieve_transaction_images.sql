@@ -0,0 +1,6 @@
+SELECT L.[Current LSN], L.[Transaction ID], L.AllocUnitId, L.Operation, L.[RowLog Contents 0],
+       L.[RowLog Contents 1], L.[Log Record]
+  FROM fn_dblog(:fromLSN, :toLSN) AS L
+  WHERE L.[Transaction ID] = :transactionID
+    AND L.Operation NOT IN ('LOP_BEGIN_XACT', 'LOP_COMMIT_XACT', 'LOP_ABORT_XACT')
+  ORDER BY L.[Current LSN];
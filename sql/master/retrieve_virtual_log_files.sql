@@ -0,0 +1,4 @@
+SELECT vlf_first_lsn, vlf_size_mb
+  FROM sys.dm_db_log_info(DB_ID())
+  WHERE vlf_active = 1
+  ORDER BY vlf_sequence_number;
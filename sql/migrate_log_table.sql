@@ -0,0 +1,28 @@
+DECLARE @dropConstraints nvarchar(max) = N'';
+
+SELECT @dropConstraints += N'ALTER TABLE ' + QUOTENAME(OBJECT_SCHEMA_NAME(parent_object_id)) + N'.'
+                           + QUOTENAME(OBJECT_NAME(parent_object_id)) + N' DROP CONSTRAINT '
+                           + QUOTENAME(name) + N'; '
+  FROM sys.objects
+  WHERE parent_object_id = OBJECT_ID(N':tableName') AND type = 'PK'
+     OR object_id IN (SELECT object_id
+                        FROM sys.default_constraints
+                        WHERE parent_object_id = OBJECT_ID(N':tableName')
+                          AND parent_column_id = COLUMNPROPERTY(OBJECT_ID(N':tableName'), N'ID', 'ColumnId'));
+
+IF INDEXPROPERTY(OBJECT_ID(N':tableName'), N'IX_EndLSN', 'IndexID') IS NOT NULL
+  DROP INDEX IX_EndLSN ON :tableName;
+
+EXEC sp_executesql @dropConstraints;
+
+ALTER TABLE :tableName DROP COLUMN ID;
+ALTER TABLE :tableName ADD ID bigint IDENTITY(1, 1) NOT NULL;
+
+WITH Repeated AS (SELECT ROW_NUMBER() OVER (PARTITION BY EndLSN ORDER BY ID) AS RowNo FROM :tableName)
+  DELETE FROM Repeated WHERE RowNo > 1;
+
+ALTER TABLE :tableName ADD PRIMARY KEY CLUSTERED (EndLSN);
+
+CREATE INDEX IX_TransactionID ON :tableName (TransactionID) INCLUDE (BeginLSN);
+CREATE INDEX IX_EndTime ON :tableName (EndTime)
+  INCLUDE (ObjectName, Operation, TransactionID, BeginTime, UserName, BeginLSN);
@@ -0,0 +1,13 @@
+IF OBJECT_ID(N':tableName', N'U') IS NOT NULL
+BEGIN
+  INSERT INTO :sharedTableName
+    (DatabaseID, Create_Date, ObjectName, Operation, TransactionID, BeginTime, EndTime, UserName, BeginLSN,
+     EndLSN)
+    SELECT ?, Create_Date, ObjectName, Operation, TransactionID, BeginTime, EndTime, UserName, BeginLSN, EndLSN
+      FROM (SELECT *, ROW_NUMBER() OVER (PARTITION BY EndLSN ORDER BY Create_Date) AS RowNo
+              FROM :tableName) AS T
+      WHERE RowNo = 1
+      ORDER BY EndLSN;
+
+  DROP TABLE :tableName;
+END
@@ -0,0 +1,9 @@
+IF OBJECT_ID(N':imageTableName', N'U') IS NOT NULL
+  DELETE I
+    FROM :imageTableName AS I
+    WHERE EXISTS (SELECT 1
+                    FROM :tableName AS T
+                    WHERE :trackedRows AND T.EndLSN > ? AND T.EndLSN <= ?
+                      AND COALESCE(T.EndTime, T.BeginTime, T.Create_Date) < ?
+                      AND T.TransactionID = I.TransactionID
+                      AND I.CurrentLSN >= T.BeginLSN AND I.CurrentLSN <= T.EndLSN);
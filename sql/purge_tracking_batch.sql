@@ -0,0 +1,2 @@
+DELETE FROM :tableName
+  WHERE :trackedRows AND EndLSN > ? AND EndLSN <= ? AND COALESCE(EndTime, BeginTime, Create_Date) < ?;
@@ -0,0 +1,5 @@
+SELECT TOP (:pageSize) ObjectName, Operation, TransactionID, BeginTime, EndTime, UserName,
+       BeginLSN, EndLSN
+  FROM :tableName
+  WHERE :trackedRows
+  ORDER BY EndLSN DESC;
@@ -0,0 +1 @@
+SELECT ScannedLSN FROM HarvestWatermarks WHERE DatabaseID = ?;
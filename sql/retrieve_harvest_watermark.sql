@@ -0,0 +1,2 @@
+SELECT COALESCE((SELECT LastLSN FROM HarvestWatermarks WHERE DatabaseID = ?),
+                (SELECT MAX(EndLSN) FROM :tableName WHERE :trackedRows));
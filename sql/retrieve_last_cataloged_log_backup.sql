@@ -0,0 +1,3 @@
+SELECT COALESCE(MAX(BackupSetID), 0)
+  FROM LogBackups
+  WHERE DatabaseID = ?;
@@ -0,0 +1,4 @@
+SELECT BackupSetID, FirstLSN, LastLSN, BackupFinished, FileName
+  FROM LogBackups
+  WHERE DatabaseID = ? AND LastLSN > ?
+  ORDER BY FirstLSN, BackupSetID DESC;
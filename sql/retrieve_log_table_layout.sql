@@ -0,0 +1,3 @@
+SELECT CASE WHEN TYPE_NAME(system_type_id) = N'uniqueidentifier' THEN 1 ELSE 2 END
+  FROM sys.columns
+  WHERE object_id = OBJECT_ID(N':tableName') AND name = N'ID';
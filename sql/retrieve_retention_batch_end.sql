@@ -0,0 +1,5 @@
+SELECT MAX(EndLSN)
+  FROM (SELECT TOP (:batchSize) EndLSN
+          FROM :tableName
+          WHERE :trackedRows AND EndLSN > ? AND COALESCE(EndTime, BeginTime, Create_Date) < ?
+          ORDER BY EndLSN) AS B;
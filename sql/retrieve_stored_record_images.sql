@@ -0,0 +1,4 @@
+SELECT CurrentLSN, TransactionID, AllocUnitId, Operation, RowLogContents0, RowLogContents1, LogRecord
+  FROM :imageTableName
+  WHERE CurrentLSN BETWEEN ? AND ? AND TransactionID = ?
+  ORDER BY CurrentLSN;
@@ -0,0 +1 @@
+SELECT CASE WHEN OBJECT_ID(N':tableName', N'U') IS NULL THEN 0 ELSE 1 END;
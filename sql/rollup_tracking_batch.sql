@@ -0,0 +1,16 @@
+MERGE HourlyTransactionSummary AS S
+  USING (SELECT DatabaseID, DATEADD(hour, DATEDIFF(hour, 0, RowTime), 0) AS HourStart,
+                COALESCE(ObjectName, N'') AS ObjectName, COUNT(*) AS NoOfTransactions,
+                MAX(EndLSN) AS LastLSN
+           FROM (SELECT DatabaseID, ObjectName, EndLSN, COALESCE(EndTime, BeginTime, Create_Date) AS RowTime
+                   FROM :tableName
+                   WHERE :trackedRows AND EndLSN > ? AND EndLSN <= ?) AS T
+           WHERE RowTime < ?
+           GROUP BY DatabaseID, DATEADD(hour, DATEDIFF(hour, 0, RowTime), 0), COALESCE(ObjectName, N'')) AS B
+  ON S.DatabaseID = B.DatabaseID AND S.HourStart = B.HourStart AND S.ObjectName = B.ObjectName
+  WHEN MATCHED THEN
+    UPDATE SET S.NoOfTransactions = S.NoOfTransactions + B.NoOfTransactions,
+               S.LastLSN = CASE WHEN B.LastLSN > S.LastLSN THEN B.LastLSN ELSE S.LastLSN END
+  WHEN NOT MATCHED THEN
+    INSERT (DatabaseID, HourStart, ObjectName, NoOfTransactions, LastLSN)
+      VALUES (B.DatabaseID, B.HourStart, B.ObjectName, B.NoOfTransactions, B.LastLSN);
@@ -0,0 +1,3 @@
+UPDATE HarvestWatermarks
+  SET LastLSN = ?, ScannedLSN = ?, UpdatedAt = CURRENT_TIMESTAMP
+  WHERE DatabaseID = ?;
@@ -0,0 +1,140 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include <QFile>
+#include <QMutexLocker>
+#include <QRegularExpression>
+#include <QSqlDatabase>
+#include "constants.h"
+#include "statementcache.h"
+
+QMutex StatementCache::_mutex;
+QHash<QString, SqlResource> StatementCache::_resources;
+QHash<QString, CachedStatements> StatementCache::_statements;
+QHash<QString, int> StatementCache::_generations;
+StatementCacheStatistics StatementCache::_statistics;
+
+SqlResource StatementCache::splitResource(const QString & queryString) {
+
+    static const QRegularExpression placeholder(QStringLiteral("(?<![\\w:]):[A-Za-z_]\\w*"));
+
+    SqlResource splitQuery;
+    int position = 0;
+
+    QRegularExpressionMatchIterator it = placeholder.globalMatch(queryString);
+    while (it.hasNext()) {
+
+        const QRegularExpressionMatch match = it.next();
+        splitQuery._fragments << queryString.mid(position, match.capturedStart() - position);
+        splitQuery._placeholders << match.captured();
+        position = match.capturedEnd();
+    }
+    splitQuery._fragments << queryString.mid(position);
+
+    return splitQuery;
+}
+
+bool StatementCache::resource(const QString & resourcePath, SqlResource & splitQuery) {
+
+    QMutexLocker locker(&_mutex);
+
+    auto cachedResource = _resources.constFind(resourcePath);
+    if (cachedResource != _resources.cend()) {
+
+        ++(_statistics._resourceHits);
+        splitQuery = cachedResource.value();
+        return true;
+    }
+
+    QFile resource(resourcePath);
+    if (!resource.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+
+    const QString queryString(resource.readAll());
+    if (queryString.isEmpty())
+        return false;
+
+    ++(_statistics._resourceMisses);
+    splitQuery = splitResource(queryString);
+    _resources.insert(resourcePath, splitQuery);
+    return true;
+}
+
+// idle statement is taken out of cache (nobody else can use it until it is checked in),
+// statement in use by other query is prepared once more; generation of connection is returned
+// to be passed back on check-in
+bool StatementCache::checkOut(const QString & connectionName, const QString & queryString,
+                              QSqlQuery & query, int & generation) {
+
+    const QString key = statementKey(query, queryString);
+
+    {
+        QMutexLocker locker(&_mutex);
+        generation = _generations.value(connectionName);
+
+        // entry of connection is created by check-in only (invalidated connection gets no entry)
+        auto statementsOfConnection = _statements.find(connectionName);
+        if (statementsOfConnection != _statements.end()) {
+
+            auto idleStatement = statementsOfConnection->_idle.find(key);
+            if (idleStatement != statementsOfConnection->_idle.end()) {
+
+                ++(_statistics._statementHits);
+                query = idleStatement.value();
+                statementsOfConnection->_idle.erase(idleStatement);
+                statementsOfConnection->_recentlyUsed.removeOne(key);
+                return true;
+            }
+        }
+        ++(_statistics._statementMisses);
+    }
+
+    return query.prepare(queryString);
+}
+
+// statements are returned only while their connection is registered and was not invalidated
+// since check-out (connection reopened or recreated under the same name by other clone),
+// least recently used idle statement is dropped if cache of connection is full
+void StatementCache::checkIn(const QString & connectionName, const QString & queryString,
+                             QSqlQuery & query, const int generation) {
+
+    const QString key = statementKey(query, queryString);
+    query.finish();
+
+    if (!QSqlDatabase::contains(connectionName))
+        return;
+
+    QMutexLocker locker(&_mutex);
+
+    if (_generations.value(connectionName) != generation)
+        return;
+
+    auto statementsOfConnection = _statements.find(connectionName);
+    if (statementsOfConnection == _statements.end())
+        statementsOfConnection = _statements.insert(connectionName, CachedStatements());
+    if (statementsOfConnection->_idle.contains(key))
+        return;
+
+    statementsOfConnection->_idle.insert(key, query);
+    statementsOfConnection->_recentlyUsed.push_back(key);
+
+    while (statementsOfConnection->_recentlyUsed.size() > sql::statementCacheCapacity)
+        statementsOfConnection->_idle.remove(statementsOfConnection->_recentlyUsed.takeFirst());
+    return;
+}
+
+void StatementCache::invalidate(const QString & connectionName) {
+
+    QMutexLocker locker(&_mutex);
+    _statements.remove(connectionName);
+    ++(_generations[connectionName]);
+    return;
+}
+
+StatementCacheStatistics StatementCache::statistics() {
+
+    QMutexLocker locker(&_mutex);
+    return _statistics;
+}
@@ -0,0 +1,66 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef STATEMENTCACHE_H
+#define STATEMENTCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QSqlQuery>
+#include <QString>
+#include <QStringList>
+
+// SQL resource split on placeholders (:name), fragments.size() == placeholders.size() + 1
+struct SqlResource {
+
+    QStringList _fragments;
+    QStringList _placeholders;
+};
+
+struct StatementCacheStatistics {
+
+    int _resourceHits = 0;
+    int _resourceMisses = 0;
+    int _statementHits = 0;
+    int _statementMisses = 0;
+};
+
+// idle prepared statements of one connection, least recently used first
+struct CachedStatements {
+
+    QHash<QString, QSqlQuery> _idle;
+    QList<QString> _recentlyUsed;
+};
+
+// resources are read from qrc and split only once, prepared statements are kept
+// per connection name (and must be invalidated whenever the connection is reopened or removed);
+// statement is checked out exclusively by one Query (QSqlQuery is shared on copy) and returned
+// to cache when Query is destroyed, at most sql::statementCacheCapacity idle statements
+// are kept per connection
+class StatementCache {
+
+    public:
+        static bool resource(const QString &, SqlResource &);
+        static bool checkOut(const QString &, const QString &, QSqlQuery &, int &);
+        static void checkIn(const QString &, const QString &, QSqlQuery &, const int);
+        static void invalidate(const QString &);
+        static StatementCacheStatistics statistics();
+
+    private:
+        static SqlResource splitResource(const QString &);
+        // cursor type is part of the key as it is fixed when statement is prepared
+        static inline QString statementKey(const QSqlQuery & query, const QString & queryString)
+            { return ((query.isForwardOnly() ? QStringLiteral("F|") : QStringLiteral("S|")) + queryString); }
+
+        static QMutex _mutex;
+        static QHash<QString, SqlResource> _resources;
+        static QHash<QString, CachedStatements> _statements;
+        // incremented by invalidation (statements checked out before are not returned)
+        static QHash<QString, int> _generations;
+        static StatementCacheStatistics _statistics;
+};
+
+#endif // STATEMENTCACHE_H
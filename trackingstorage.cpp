@@ -0,0 +1,147 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include "database.h"
+#include "query.h"
+#include "trackingstorage.h"
+
+// row of query (columns in order of select list)
+struct SharedTableRow {
+
+    int _exists;
+};
+
+const TrackingStorage * TrackingStorage::instance(const storageMode mode) {
+
+    static const TablePerDatabaseStorage tablePerDatabase;
+    static const SharedTableStorage sharedTable;
+
+    return (mode == SHARED_TABLE) ? static_cast<const TrackingStorage *>(&sharedTable)
+                                  : static_cast<const TrackingStorage *>(&tablePerDatabase);
+}
+
+TrackingStorage::storageMode TrackingStorage::detectMode(const QSqlDatabase * systemConnection) {
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), logTableLabels._sharedTableName) };
+
+    Query * const queryToExecute = new Query(systemConnection, customBindings);
+    SharedTableRow sharedTableRow { 0 };
+
+    if (queryToExecute->prepareQuery(QStringLiteral(":/query/sql/retrieve_table_exists.sql")))
+        queryToExecute->selectFirstRow(mapColumns(&SharedTableRow::_exists), sharedTableRow);
+
+    delete queryToExecute;
+    return (sharedTableRow._exists != 0) ? SHARED_TABLE : TABLE_PER_DATABASE;
+}
+
+// one transaction of system database => databases are switched all together or not at all
+// (moving is repeatable, tables which were moved already do not exist any more)
+bool TrackingStorage::createSharedTable(const QSqlDatabase * systemConnection, const QVector<QUuid> & IDs) {
+
+    QSqlDatabase connection = QSqlDatabase::database(systemConnection->connectionName());
+    bool dataModified = connection.transaction();
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { qMakePair<QString, QString>(QStringLiteral(":tableName"), logTableLabels._sharedTableName) };
+
+    Query * const queryToExecute = new Query(systemConnection, customBindings);
+    dataModified = dataModified &&
+        queryToExecute->prepareQuery(QStringLiteral(":/query/sql/create_shared_log_table.sql")) &&
+        queryToExecute->processModifyQuery();
+    delete queryToExecute;
+
+    const TrackingStorage * const tablePerDatabase = instance(TABLE_PER_DATABASE);
+    for (auto it = IDs.cbegin(); dataModified && it != IDs.cend(); ++it) {
+
+        const QVector<QPair<QString, QString>> moveBindings
+          { { qMakePair<QString, QString>(QStringLiteral(":tableName"), tablePerDatabase->tableName(*it)) },
+            { qMakePair<QString, QString>(QStringLiteral(":sharedTableName"),
+                                          logTableLabels._sharedTableName) } };
+
+        Query * const moveRows = new Query(systemConnection, moveBindings);
+        dataModified =
+            moveRows->prepareQuery(QStringLiteral(":/query/sql/move_log_table_to_shared_table.sql"));
+        if (dataModified) {
+
+            moveRows->setBinding(0, QVariant(it->toString(QUuid::WithoutBraces)));
+            dataModified = moveRows->processModifyQuery();
+        }
+        delete moveRows;
+    }
+
+    if (dataModified)
+        dataModified = connection.commit();
+    else
+        connection.rollback();
+    return dataModified;
+}
+
+QString TablePerDatabaseStorage::tableName(const QUuid & ID) const {
+
+    return (logTableLabels._prefix + ID.toString(QUuid::WithoutBraces));
+}
+
+bool TablePerDatabaseStorage::create(const QSqlDatabase * systemConnection, const QUuid & ID) const {
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/create_new_log_table.sql");
+    bool dataModified = false;
+
+    QString foreignKeyName = logTableLabels._foreignKeyName;
+    foreignKeyName.replace(QStringLiteral("[tableName]"), this->tableName(ID));
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->tableName(ID)) },
+        { qMakePair<QString, QString>(QStringLiteral(":foreignKeyName"), foreignKeyName) } };
+
+    Query * const queryToExecute = new Query(systemConnection, customBindings);
+
+    if (queryToExecute->prepareQuery(resourceForQuery)) {
+
+        dataModified = queryToExecute->processModifyQuery();
+    }
+    delete queryToExecute;
+    return dataModified;
+}
+
+bool TablePerDatabaseStorage::drop(const QSqlDatabase * systemConnection, const QUuid & ID) const {
+
+    const QString resourceForQuery = QStringLiteral(":/query/sql/drop_log_table.sql");
+    bool dataModified = false;
+
+    // set custom bindings
+    const QVector<QPair<QString, QString>> customBindings
+      { { qMakePair<QString, QString>(QStringLiteral(":tableName"), this->tableName(ID)) } };
+
+    Query * const queryToExecute = new Query(systemConnection, customBindings);
+
+    if (queryToExecute->prepareQuery(resourceForQuery)) {
+
+        dataModified = queryToExecute->processModifyQuery();
+    }
+    delete queryToExecute;
+    return dataModified;
+}
+
+QString SharedTableStorage::tableName(const QUuid &) const {
+
+    return logTableLabels._sharedTableName;
+}
+
+// rows are purged by batches before (Database::purgeLogTableOfThisDB), cascade removes only rows
+// stored meanwhile; own table left from time before shared table was created (if any) is dropped
+bool SharedTableStorage::drop(const QSqlDatabase * systemConnection, const QUuid & ID) const {
+
+    return instance(TABLE_PER_DATABASE)->drop(systemConnection, ID);
+}
+
+// ID is formatted by QUuid (literal is safe), leading column of clustered key
+QString SharedTableStorage::rowsOfDatabase(const QUuid & ID) const {
+
+    return QStringLiteral("DatabaseID = '%1'").arg(ID.toString(QUuid::WithoutBraces));
+}
@@ -0,0 +1,61 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef TRACKINGSTORAGE_H
+#define TRACKINGSTORAGE_H
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QUuid>
+#include <QVector>
+
+// where tracked transactions of database are kept in system database; queries address rows
+// of database by name of table and condition (replaces :trackedRows placeholder)
+class TrackingStorage {
+
+    public:
+        enum storageMode { TABLE_PER_DATABASE, SHARED_TABLE };
+
+        virtual ~TrackingStorage() {}
+
+        // storages are stateless, one instance per mode is shared by all databases (and threads)
+        static const TrackingStorage * instance(const storageMode);
+        // shared table is used once it exists in system database
+        static storageMode detectMode(const QSqlDatabase *);
+        // rows of own tables of given databases are moved into shared table (own tables are dropped)
+        static bool createSharedTable(const QSqlDatabase *, const QVector<QUuid> &);
+
+        virtual storageMode mode() const = 0;
+        virtual QString tableName(const QUuid &) const = 0;
+        virtual QString rowsOfDatabase(const QUuid &) const = 0;
+        // database is added/removed (in transaction of system database opened by caller)
+        virtual bool create(const QSqlDatabase *, const QUuid &) const = 0;
+        virtual bool drop(const QSqlDatabase *, const QUuid &) const = 0;
+};
+
+// own table Track_DB_<ID> for every database (created and dropped with it)
+class TablePerDatabaseStorage: public TrackingStorage {
+
+    public:
+        storageMode mode() const override { return TABLE_PER_DATABASE; }
+        QString tableName(const QUuid &) const override;
+        QString rowsOfDatabase(const QUuid &) const override { return QStringLiteral("1 = 1"); }
+        bool create(const QSqlDatabase *, const QUuid &) const override;
+        bool drop(const QSqlDatabase *, const QUuid &) const override;
+};
+
+// one table clustered by (DatabaseID, EndLSN) for all databases, adding of database does not
+// change schema and its rows are removed with its record in TrackedDatabases (cascade)
+class SharedTableStorage: public TrackingStorage {
+
+    public:
+        storageMode mode() const override { return SHARED_TABLE; }
+        QString tableName(const QUuid &) const override;
+        QString rowsOfDatabase(const QUuid &) const override;
+        bool create(const QSqlDatabase *, const QUuid &) const override { return true; }
+        bool drop(const QSqlDatabase *, const QUuid &) const override;
+};
+
+#endif // TRACKINGSTORAGE_H
@@ -0,0 +1,87 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#include "transactionassembler.h"
+
+TransactionAssembler::TransactionAssembler(const HarvestPosition & startPosition):
+    _previouslyScannedLSN(startPosition._scannedLSN), _lastLSN(startPosition._watermark),
+    _noOfRepeatedCommits(0) {}
+
+bool TransactionAssembler::append(const LogRecordRow & record, const QString & objectName,
+                                  TrackedTransaction & completedTransaction) {
+
+    static const QString beginOperation = QStringLiteral("LOP_BEGIN_XACT");
+    static const QString commitOperation = QStringLiteral("LOP_COMMIT_XACT");
+    static const QString abortOperation = QStringLiteral("LOP_ABORT_XACT");
+    static const QString noTransaction = QStringLiteral("0000:00000000");
+
+    if (record._transactionID == noTransaction) {
+
+        this->_lastLSN = record._currentLSN;
+        return false;
+    }
+
+    auto transaction = this->_openTransactions.find(record._transactionID);
+    if (transaction == this->_openTransactions.end()) {
+
+        OpenTransaction newTransaction;
+        newTransaction._row._transactionName = record._transactionName;
+        newTransaction._row._transactionID = record._transactionID;
+        newTransaction._row._beginTime = record._beginTime;
+        newTransaction._row._userName = record._userName;
+        newTransaction._precedingLSN = this->_lastLSN;
+        newTransaction._beginSeen = (record._operation == beginOperation);
+
+        transaction = this->_openTransactions.insert(record._transactionID, newTransaction);
+        if (newTransaction._beginSeen)
+            this->_openTransactionsByFirstLSN.insert(record._currentLSN, record._transactionID);
+    }
+
+    TrackedTransaction & row = transaction.value()._row;
+    if (row._objectName.isEmpty())
+        row._objectName = objectName;
+    row._range.extend(record._currentLSN);
+    this->_lastLSN = record._currentLSN;
+
+    const bool committed = (record._operation == commitOperation);
+    if (!committed && record._operation != abortOperation) {
+
+        if (record._operation != beginOperation)
+            ++(row._noOfDataRecords);
+        return false;
+    }
+
+    // end time is known from commit record only
+    if (committed) {
+
+        completedTransaction = row;
+        completedTransaction._endTime = record._endTime;
+    }
+    if (transaction.value()._beginSeen)
+        this->_openTransactionsByFirstLSN.remove(row._range.from());
+    this->_openTransactions.erase(transaction);
+
+    if (!committed)
+        return false;
+
+    // transaction committed before previous harvest stopped is already stored
+    if (record._currentLSN <= this->_previouslyScannedLSN) {
+
+        ++(this->_noOfRepeatedCommits);
+        return false;
+    }
+
+    completedTransaction._position = this->position();
+    return true;
+}
+
+HarvestPosition TransactionAssembler::position() const {
+
+    HarvestPosition position;
+    position._watermark = this->_openTransactionsByFirstLSN.isEmpty() ? this->_lastLSN
+        : this->_openTransactions.value(this->_openTransactionsByFirstLSN.first())._precedingLSN;
+    position._scannedLSN = LSN::max(this->_lastLSN, this->_previouslyScannedLSN);
+    return position;
+}
@@ -0,0 +1,54 @@
+/*******************************************************************************
+ Copyright 2020 Daniel Neuwirth
+ This program is distributed under the terms of the GNU General Public License.
+*******************************************************************************/
+
+#ifndef TRANSACTIONASSEMBLER_H
+#define TRANSACTIONASSEMBLER_H
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include "database.h"
+#include "lsn.h"
+
+// streaming reassembly of transactions from log records (in LSN order): first record (normally
+// LOP_BEGIN_XACT) opens transaction, LOP_COMMIT_XACT completes it (row is emitted), LOP_ABORT_XACT
+// discards it. Only aggregates of open transactions are kept (not their records) => memory
+// depends on number of open transactions, not on their length (memory of whole harvest is bounded
+// only if records are fed while log is read, i.e. in pipelined harvest). Transactions still open at the end
+// are not emitted, watermark stays before the oldest of them, so they are read again (from their
+// beginning) by next harvest; transactions committed up to previously scanned LSN are not
+// emitted again. Records outside of any transaction (ID 0000:00000000, e.g. checkpoints) are
+// skipped; transactions whose beginning was not seen (they began before scanned range) are
+// emitted as they are, but they do not hold watermark (it could not be moved before them anyway)
+class TransactionAssembler {
+
+    public:
+        TransactionAssembler(const HarvestPosition &);
+        ~TransactionAssembler() {}
+
+        // true = record completed transaction, which has not been emitted yet
+        bool append(const LogRecordRow &, const QString &, TrackedTransaction &);
+        // log up to watermark is covered by emitted transactions, all records up to scanned LSN were seen
+        HarvestPosition position() const;
+        inline int noOfOpenTransactions() const { return _openTransactions.size(); }
+        // commits up to previously scanned LSN (not emitted)
+        inline int noOfRepeatedCommits() const { return _noOfRepeatedCommits; }
+
+    private:
+        struct OpenTransaction {
+
+            TrackedTransaction _row;
+            LSN _precedingLSN;
+            bool _beginSeen;
+        };
+
+        QHash<QString, OpenTransaction> _openTransactions;
+        QMap<LSN, QString> _openTransactionsByFirstLSN;
+        const LSN _previouslyScannedLSN;
+        LSN _lastLSN;
+        int _noOfRepeatedCommits;
+};
+
+#endif // TRANSACTIONASSEMBLER_H